@@ -0,0 +1,49 @@
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Number of heap allocations made through operator new so far, which only
+// counts anything once FOAM_COUNT_ALLOCATIONS has been placed in the program
+inline std::atomic<uint64_t> &allocation_counter()
+{
+	static std::atomic<uint64_t> counter(0);
+
+	return counter;
+}
+
+inline uint64_t allocation_count()
+{
+	return allocation_counter().load(std::memory_order_relaxed);
+}
+
+// Replaces the global operator new and delete with ones that count the
+// allocations. Replacements can only be defined once in the whole program,
+// so this goes at file scope, in a single source file of the application.
+#define FOAM_COUNT_ALLOCATIONS \
+void *operator new(std::size_t size) \
+{ \
+	allocation_counter().fetch_add(1, std::memory_order_relaxed); \
+\
+	if (const auto pointer = std::malloc(size ? size : 1)) \
+	{ \
+		return pointer; \
+	} \
+\
+	throw std::bad_alloc(); \
+} \
+\
+void operator delete(void *pointer) noexcept \
+{ \
+	std::free(pointer); \
+} \
+\
+void operator delete(void *pointer, std::size_t) noexcept \
+{ \
+	std::free(pointer); \
+}
+
+#endif // ALLOCATIONS_H
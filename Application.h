@@ -3,294 +3,501 @@
 
 #include <iostream>
 
-#include <freetype2/ft2build.h>
+#include "Repack.h"
+#include "GLRenderer.h"
+#include "Allocations.h"
+#include "Timers.h"
+#include "Timings.h"
+#include "Trace.h"
 
-#include FT_FREETYPE_H
+template<typename TApplication, typename TUserState, typename TStyle, typename TRenderer = GLRenderer>
+struct Application
+{
+	template<typename T>
+	using DrawableControlTypePredicate = std::is_base_of<DrawableControl, T>;
 
-#include "Repack.h"
+	// Overlays are drawn, but do not count towards the hash
+	template<typename T>
+	using HashedControlTypePredicate = std::bool_constant<std::is_base_of_v<DrawableControl, T> && !std::is_base_of_v<OverlayControl, T>>;
 
-#include "incbin.h"
+	template<typename T>
+	using UnfusedControlTypePredicate = std::is_base_of<UnfusedControl, T>;
 
-INCBIN(VertexShader, "shader.vert");
-INCBIN(FragmentShader, "shader.frag");
+	template<typename T>
+	using InteractiveControlTypePredicate = std::is_base_of<InteractiveControl, T>;
 
-#define offset(t, d) reinterpret_cast<void *>(offsetof(t, d))
+	virtual ~Application() = default;
 
-glm::vec4 get_glyph_position(FT_Face face, uint x, uint y)
-{
-	return (x + face->glyph->bitmap.width) > TEXTURE_SIZE
-		? glm::vec4(0, y + uint(face->height / 64), face->glyph->bitmap.width, face->glyph->bitmap.rows)
-		: glm::vec4(x, y, face->glyph->bitmap.width, face->glyph->bitmap.rows);
-}
+	virtual TUserState init_state()
+	{
+		return TUserState();
+	}
 
-Glyph create_glyph(FT_Face face, size_t index, uint x, uint y)
-{
-	FT_Load_Char(face, index, FT_LOAD_RENDER);
+	// Called before an event is delivered to the controls. Frames where no
+	// control reacts to any of the events are skipped, and this is not called.
+	// Anything that should happen at a certain rate, and not as input arrives,
+	// belongs in a timer.
+	virtual TUserState update_state(const TUserState &state)
+	{
+		return state;
+	}
 
-	return
+	// Applies "on_tick" to the user state every "interval" milliseconds, or
+	// once after that long. Timers that are due at the same time are laid out
+	// together. Returns an id to stop the timer with.
+	int start_timer(Uint32 interval, Callback<TUserState> on_tick, TimerMode mode = TimerMode::Periodic)
 	{
-		index,
+		return m_timers.start(interval, on_tick, mode);
+	}
 
-		get_glyph_position(face, x, y),
+	void stop_timer(int id)
+	{
+		m_timers.stop(id);
+	}
 
-		face->glyph->advance.x >> 6,
-		face->glyph->advance.y >> 6,
-		face->height / 64 - face->glyph->bitmap_top,
-	};
-}
+	// How much memory the glyph atlas may use before glyphs start getting evicted
+	virtual std::size_t glyph_budget() const
+	{
+		return DEFAULT_GLYPH_BUDGET;
+	}
 
-template<typename TElement, std::size_t TSize, std::size_t ...TIndex>
-std::array<TElement, TSize + 1> array_append(const TElement &element, const std::array<TElement, TSize> &array, std::index_sequence<TIndex...>)
-{
-	return { std::get<TIndex>(array)..., element };
-}
+	// Decides whether "next" makes "previous" redundant, in which case only "next"
+	// is delivered. Events that are not coalesced are delivered in order.
+	virtual bool coalesce(const SDL_Event &previous, const SDL_Event &next)
+	{
+		return previous.type == SDL_MOUSEMOTION && next.type == SDL_MOUSEMOTION;
+	}
 
-template<typename TElement, std::size_t TSize>
-std::array<TElement, TSize + 1> array_append(const TElement &element, const std::array<TElement, TSize> &array)
-{
-	return array_append(element, array, std::make_index_sequence<TSize>());
-}
+	// Where the trace is written on exit, when built with FOAM_TRACE
+	virtual std::string trace_path() const
+	{
+		return "foam.trace.json";
+	}
 
-template<std::size_t TStart, std::size_t TEnd>
-struct create_glyphs
-{
-	static auto value(FT_Face face, uint x, uint y)
+	// Where rasterized glyphs are kept between runs, or an empty string to not keep them
+	virtual std::string glyph_cache_path() const
 	{
-		const auto &glyph = create_glyph(face, TEnd - 1, x, y);
-		const auto &trailing = create_glyphs<TStart, TEnd - 1>::value(face, uint(glyph.bounds.x + glyph.bounds.z), uint(glyph.bounds.y));
+		const auto directory = SDL_GetPrefPath("Foam", "Foam");
 
-		return array_append(glyph, trailing);
+		if (!directory)
+		{
+			return std::string();
+		}
+
+		const auto &path = std::string(directory) + "glyphs.cache";
+
+		SDL_free(directory);
+
+		return path;
 	}
-};
 
-template<std::size_t TStart>
-struct create_glyphs<TStart, TStart>
-{
-	static std::array<Glyph, 1> value(FT_Face face, uint x, uint y)
+	// Each item moves the state along to the next one, so the state is only
+	// copied when passed here as an lvalue, and where a control changes
+	template <Operation TOperation, typename TState>
+	auto layout(TState state)
 	{
-		return { create_glyph(face, TStart - 1, x, y) };
+		TRACE_SCOPE(operation_name(TOperation));
+
+		const auto &root = TApplication::layout(std::get<TUserState>(state));
+
+		return strip_context(root.build(make_context<TOperation, TStyle>(std::move(state))));
 	}
-};
 
-template<typename TApplication, typename TUserState, typename TStyle>
-struct Application
-{
-	template<typename T>
-	using DrawableControlTypePredicate = std::is_base_of<DrawableControl, T>;
+	// The state as it is before "event" is delivered to the controls
+	template<typename TState>
+	TState prepare(const TState &state, const SDL_Event &event)
+	{
+		const auto &user = std::get<TUserState>(state);
+		auto updated_state = repack(state, traced("update_state", [&]
+		{
+			return update_state(user);
+		}));
+		const auto &root = std::get<RootState>(updated_state).with_event(event);
 
-	virtual ~Application() = default;
+		return repack(std::move(updated_state), root);
+	}
 
-	virtual TUserState init_state()
+	// Bounds of the interactive controls in "state", as the hit index keeps them
+	template<typename TState, std::size_t ...TIndex>
+	static std::vector<HitEntry> hit_entries(const TState &state, std::index_sequence<TIndex...>)
 	{
-		return TUserState();
+		return
+		{
+			make_hit_entry(get_control_id_v<std::tuple_element_t<TIndex, TState>>
+				, std::get<TIndex>(state).position
+				, std::get<TIndex>(state).size
+				)...
+		};
 	}
 
-	virtual TUserState update_state(const TUserState &state)
+	// Brings the hit index up to date after a pass, which only means building
+	// a new one if a control has moved or changed size
+	template<typename TState>
+	TState index_hits(TState state)
 	{
-		return state;
+		TRACE_SCOPE("index_hits");
+
+		using Sequence = make_filtered_sequence_t<InteractiveControlTypePredicate, TState, std::make_index_sequence<std::tuple_size_v<TState>>>;
+
+		auto entries = hit_entries(state, Sequence());
+
+		const auto &root = std::get<RootState>(state);
+
+		if (root.hits && root.hits->entries() == entries)
+		{
+			return state;
+		}
+
+		auto hits = std::make_shared<const HitIndex>(std::move(entries), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+		return repack(std::move(state), root.with_hits(std::move(hits)));
 	}
 
-	template <Operation TOperation, typename TState>
-	auto layout(const TState &state)
+	template<typename TState, std::size_t ...TIndex>
+	static bool is_affected(const TState &state, const RootState &root, std::index_sequence<TIndex...>)
 	{
-		const auto &user = std::get<TUserState>(state);
-		const auto &root = TApplication::layout(user);
-		const auto &context = make_context<TOperation, TStyle>(state);
-		const auto &result = root.build(context);
+		return (std::get<TIndex>(state).is_affected(root) || ...);
+	}
 
-		return strip_context(result);
+	// Whether no control would react to "event", were it delivered to "state".
+	// Only interactive controls read events, so the others are not asked.
+	template<typename TState>
+	bool is_inert(const TState &state, const SDL_Event &event)
+	{
+		using Sequence = make_filtered_sequence_t<InteractiveControlTypePredicate, TState, std::make_index_sequence<std::tuple_size_v<TState>>>;
+
+		const auto &root = std::get<RootState>(state).with_event(event);
+
+		return !is_affected(state, root, Sequence());
 	}
 
+	// Delivers a single event to the controls
 	template<typename TState>
-	void run(TState state)
+	TState update(const TState &state, const SDL_Event &event)
 	{
-		SDL_Event event;
+		return index_hits(layout<Operation::Update>(prepare(state, event)));
+	}
 
-		// This is unfortunate, but we apparently cannot rely on tail call optimization here :(
-		while (true)
-		{
-			const auto &root = std::get<RootState>(state);
+	// Delivers the events to the controls, and draws them after the last one.
+	// Unless a control needs the Update of every other control first, the last
+	// event is delivered in the same pass as the controls are drawn.
+	template<typename TState>
+	TState update_and_draw(const TState &state, const std::vector<SDL_Event> &events)
+	{
+		constexpr auto fused = std::tuple_size_v<decltype(tuple_filter<UnfusedControlTypePredicate>(state))> == 0;
 
-			SDL_WaitEvent(&event);
+		const auto deliver = [this](const TState &state, const SDL_Event &event)
+		{
+			return update(state, event);
+		};
 
-			if (event.type == SDL_QUIT)
+		if constexpr (fused)
+		{
+			if (!events.empty())
 			{
-				return;
+				const auto &updated = std::accumulate(std::begin(events), std::end(events) - 1, state, deliver);
+
+				return index_hits(layout<Operation::Fused>(prepare(updated, events.back())));
 			}
+		}
 
-			const auto &user = std::get<TUserState>(state);
-			const auto &updated_state = repack(state, update_state(user));
-			const auto &with_events = repack(updated_state, root.with_event(event));
+		return layout<Operation::Draw>(std::accumulate(std::begin(events), std::end(events), state, deliver));
+	}
 
-			state = layout<Operation::Draw>(
-				layout<Operation::Update>(
-					with_events
-				)
-			);
+	// Applies the timers that pushed any of "events" to the user state
+	template<typename TState>
+	TState tick(const TState &state, const std::vector<SDL_Event> &events)
+	{
+		TRACE_SCOPE("timers");
 
-			const auto &drawables = tuple_filter<DrawableControlTypePredicate>(state);
-			const auto &hash = compute_hash(drawables);
+		const auto &user = std::accumulate(std::begin(events), std::end(events), std::get<TUserState>(state), [this](const TUserState &user, const SDL_Event &event)
+		{
+			return m_timers.tick(user, event);
+		});
 
-			if (hash == root.hash)
-			{
-				continue;
-			}
+		return repack(state, user);
+	}
 
-			state = repack(state, root.with_hash(hash));
+	// Handles a batch of events, and paints the result if anything changed
+	template<typename TState>
+	TState frame(const TState &previous, const std::vector<SDL_Event> &events)
+	{
+		TRACE_SCOPE("frame");
 
-			const auto &commands = extract_draw_commands(drawables);
+		const auto is_tick = [this](const SDL_Event &event)
+		{
+			return m_timers.is_tick(event);
+		};
 
-			glClear(GL_COLOR_BUFFER_BIT);
+		// Ticks only change the user state, so they are all applied up front, and
+		// lead to a single layout. The controls are given the last one if there
+		// is nothing else, to be updated with the new user state.
+		if (std::any_of(std::begin(events), std::end(events), is_tick))
+		{
+			std::vector<SDL_Event> input;
 
-			glBindBuffer(GL_ARRAY_BUFFER, root.commands);
-			glBufferData(GL_ARRAY_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STATIC_DRAW);
+			std::remove_copy_if(std::begin(events), std::end(events), std::back_inserter(input), is_tick);
 
-			glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DrawCommand), offset(DrawCommand, color));
-			glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, uv));
-			glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, matrix));
-			glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(DrawCommand), (void *)(sizeof(glm::vec3) * 1));
-			glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(DrawCommand), (void *)(sizeof(glm::vec3) * 2));
+			if (input.empty())
+			{
+				input.push_back(events.back());
+			}
 
-			glVertexAttribDivisor(1, 1);
-			glVertexAttribDivisor(2, 1);
-			glVertexAttribDivisor(3, 1);
-			glVertexAttribDivisor(4, 1);
-			glVertexAttribDivisor(5, 1);
+			return paint(previous, tick(previous, events), input);
+		}
 
-			glBindBuffer(GL_ARRAY_BUFFER, root.vbo);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, root.ibo);
+		// Nothing would change, so there is no need to lay anything out, or
+		// to compute a hash to find that out. Until the first frame has been
+		// painted, the controls do not even know where they are.
+		const auto inert = std::get<RootState>(previous).hash && traced("inert", [&]
+		{
+			return std::all_of(std::begin(events), std::end(events), [&](const SDL_Event &event)
+			{
+				return is_inert(previous, event);
+			});
+		});
 
-			glDrawElementsInstanced(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, 0, commands.size());
+		if (inert)
+		{
+			const auto &root = std::get<RootState>(previous);
 
-			SDL_GL_SwapWindow(root.window);
+			return repack(previous, root
+				.with_statistics(root.statistics
+					.with_skipped(root.statistics.skipped + 1)
+					)
+				);
 		}
+
+		return paint(previous, previous, events);
 	}
 
-	void run()
+	// Delivers "events" to "current", and paints the result if it differs from
+	// "previous", the state that was painted last
+	template<typename TState>
+	TState paint(const TState &previous, const TState &current, const std::vector<SDL_Event> &events)
 	{
-		SDL_Init(SDL_INIT_EVERYTHING);
+		const auto started = timing_now();
+		const auto allocations = allocation_count();
 
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 1);
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+		const Bounds screen(glm::vec2(0, 0), glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT));
 
-		auto window = SDL_CreateWindow("Foam", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 800, 600, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
-		auto context = SDL_GL_CreateContext(window);
+		const auto &glyphs = std::get<RootState>(current).glyphs;
+		const auto generation = glyphs->generation();
 
-		glewInit();
+		glyphs->begin_frame();
 
-		SDL_GL_SetSwapInterval(1);
+		// If glyphs had to be evicted to make room for new ones, controls that
+		// were drawn before that happened might refer to glyphs that are gone,
+		// so they are given a chance to draw again. Glyphs used by this frame
+		// are never evicted, so once is enough.
+		const auto &drawn = update_and_draw(current, events);
+		const auto &state = glyphs->generation() == generation
+			? drawn
+			: layout<Operation::Draw>(drawn);
 
-		FT_Library library;
-		FT_Face face;
+		const auto laid_out = timing_now();
 
-		FT_Init_FreeType(&library);
-		FT_New_Face(library, "/usr/share/fonts/cantarell/Cantarell-Regular.otf", 0, &face);
-		FT_Set_Char_Size(face, 0, 11 * 64, 96, 96);
+		const auto &root = std::get<RootState>(state);
+		const auto &drawables = tuple_filter<DrawableControlTypePredicate>(state);
+		const auto &hash = traced("hash", [&]
+		{
+			using Drawables = std::decay_t<decltype(drawables)>;
+			using Sequence = make_filtered_sequence_t<HashedControlTypePredicate, Drawables, std::make_index_sequence<std::tuple_size_v<Drawables>>>;
 
-		RootState root;
-		root.window = window;
-		root.context = context;
-		root.glyphs = create_glyphs<33, 128>::value(face, 0, 0);
-		root.font_height = uint(face->height / 64);
+			return compute_hash(drawables, Sequence());
+		});
 
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		if (hash == root.hash)
+		{
+			return repack(state, root
+				.with_statistics(root.statistics
+					.with_unchanged(root.statistics.unchanged + 1)
+					)
+				);
+		}
 
-		glGenVertexArrays(1, &root.vao);
-		glBindVertexArray(root.vao);
+		// Nothing has been painted yet, so everything is damaged
+		const auto &damage = traced("damage", [&]
+		{
+			return root.hash
+				? compute_damage(tuple_filter<DrawableControlTypePredicate>(previous), drawables).snapped().intersected(screen)
+				: screen;
+		});
 
-		glActiveTexture(GL_TEXTURE0);
-		glGenTextures(1, &root.font);
-		glBindTexture(GL_TEXTURE_2D, root.font);
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		const auto rendering = timing_now();
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, TEXTURE_SIZE, TEXTURE_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+		m_frame_timings.record(rendering - started);
 
-		for (const auto &glyph : root.glyphs)
 		{
-			FT_Load_Char(face, glyph.index, FT_LOAD_RENDER);
+			TRACE_SCOPE("upload_glyphs");
 
-			glTexSubImage2D(GL_TEXTURE_2D, 0, int(glyph.bounds.x), int(glyph.bounds.y), int(glyph.bounds.z), int(glyph.bounds.w), GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
+			m_renderer.upload_glyphs(*glyphs);
 		}
 
-		const auto program = glCreateProgram();
+		{
+			TRACE_SCOPE("draw");
 
-		const auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		const auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+			m_renderer.draw(drawables, damage);
+		}
 
-		const auto *vs_source = reinterpret_cast<const GLchar *>(&gVertexShaderData);
-		const auto *fs_source = reinterpret_cast<const GLchar *>(&gFragmentShaderData);
+		{
+			TRACE_SCOPE("present");
 
-		glShaderSource(vertexShader, 1, &vs_source, reinterpret_cast<const GLint *>(&gVertexShaderSize));
-		glShaderSource(fragmentShader, 1, &fs_source, reinterpret_cast<const GLint *>(&gFragmentShaderSize));
+			m_renderer.present();
+		}
 
-		glCompileShader(vertexShader);
-		glCompileShader(fragmentShader);
+		const auto finished = timing_now();
+
+		m_render_timings.record(finished - rendering);
+
+		return repack(state, root
+			.with_hash(hash)
+			.with_statistics(root.statistics
+				.with_damage(damage)
+				.with_damaged_area(damage.area())
+				.with_painted(root.statistics.painted + 1)
+				.with_frame_time(finished - started)
+				.with_layout_time(laid_out - started)
+				.with_instances(count_draw_commands(drawables))
+				.with_uploaded_bytes(m_renderer.uploaded_bytes())
+				.with_allocations(allocation_count() - allocations)
+				)
+			);
+	}
 
-		glAttachShader(program, vertexShader);
-		glAttachShader(program, fragmentShader);
+	// Rolling statistics of the frames painted lately, on the CPU and the GPU
+	FrameTimings timings() const
+	{
+		FrameTimings timings;
 
-		glLinkProgram(program);
+		timings.frame = m_frame_timings.summary();
+		timings.render = m_render_timings.summary();
+		timings.gpu = m_renderer.gpu_timings();
 
-		glClearColor(0.f, 0.f, 0.f, 1.f);
+		return timings;
+	}
 
-		const auto &state = init_state();
+	template<typename TState>
+	TState frame(const TState &previous, const SDL_Event &event)
+	{
+		return frame(previous, std::vector<SDL_Event> { event });
+	}
 
-		glGenBuffers(1, &root.vbo);
-		glGenBuffers(1, &root.ibo);
-		glGenBuffers(1, &root.commands);
+	// Blocks until there is at least one event, and then drains the queue,
+	// coalescing redundant events on the way
+	void wait_events(std::vector<SDL_Event> &events)
+	{
+		TRACE_SCOPE("wait_events");
+
+		SDL_Event buffer[64];
+
+		events.clear();
 
-		glUseProgram(program);
+		SDL_WaitEvent(buffer);
 
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-		glEnableVertexAttribArray(3);
-		glEnableVertexAttribArray(4);
-		glEnableVertexAttribArray(5);
+		auto count = 1;
 
-		static const GLfloat vertex_data[] =
+		do
 		{
-			0.f, 0.f,
-			1.f, 0.f,
-			1.f, 1.f,
-			0.f, 1.f
-		};
+			for (auto i = 0; i < count; i++)
+			{
+				if (!events.empty() && coalesce(events.back(), buffer[i]))
+				{
+					events.back() = buffer[i];
+				}
+				else
+				{
+					events.push_back(buffer[i]);
+				}
+			}
 
-		glBindBuffer(GL_ARRAY_BUFFER, root.vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_data), vertex_data, GL_STATIC_DRAW);
+			SDL_PumpEvents();
 
-		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+			count = SDL_PeepEvents(buffer, 64, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+		}
+		while (count > 0);
+	}
+
+	template<typename TState>
+	void run(TState state)
+	{
+		std::vector<SDL_Event> events;
 
-		static const GLuint index_data[] =
+		// This is unfortunate, but we apparently cannot rely on tail call optimization here :(
+		while (true)
 		{
-			0, 1, 2, 3
-		};
+			wait_events(events);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, root.ibo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(index_data), index_data, GL_STATIC_DRAW);
+			const auto quit = std::find_if(std::begin(events), std::end(events), [](const SDL_Event &event)
+			{
+				return event.type == SDL_QUIT;
+			});
 
+			if (quit != std::end(events))
+			{
+				return;
+			}
+
+			state = frame(state, events);
+		}
+	}
+
+	// Sets up the renderer and returns the initial state, ready to be passed to frame
+	auto initialize()
+	{
+		SDL_Init(SDL_INIT_EVENTS | SDL_INIT_TIMER);
+
+		RootState root;
+		root.glyphs = std::make_shared<GlyphCache>(glyph_budget());
+		root.layouts = std::make_shared<TextLayoutCache>();
+
+		// Text is left empty rather than crashing when the font is missing
+		if (root.glyphs->add_font(DEFAULT_FONT_PATH) == NO_FONT)
+		{
+			std::cerr << "Could not read " << DEFAULT_FONT_PATH << std::endl;
+		}
+
+		// Rasterizing glyphs is what dominates startup, so the result is kept
+		// around for the next time
+		const auto &cache = glyph_cache_path();
+
+		if (!root.glyphs->load(cache, DEFAULT_FONT, DEFAULT_FONT_SIZE))
+		{
+			root.glyphs->prewarm(DEFAULT_FONT, DEFAULT_FONT_SIZE, 32, 127);
+			root.glyphs->save(cache, DEFAULT_FONT, DEFAULT_FONT_SIZE);
+		}
+
+		root.font_height = root.glyphs->line_height(DEFAULT_FONT, DEFAULT_FONT_SIZE);
+
+		m_renderer.create();
+		m_renderer.upload_glyphs(*root.glyphs);
+
+		const auto &state = init_state();
 		const auto tuple = std::make_tuple(root, state);
 
-		run(layout<Operation::Initialize>(tuple));
+		return layout<Operation::Initialize>(tuple);
+	}
 
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
-		glDisableVertexAttribArray(3);
-		glDisableVertexAttribArray(4);
-		glDisableVertexAttribArray(5);
+	void run()
+	{
+		run(initialize());
 
-		glUseProgram(0);
-		glDeleteProgram(program);
+		m_renderer.destroy();
+		m_timers.clear();
 
-		SDL_DestroyWindow(window);
+#ifdef FOAM_TRACE
+		Trace::instance().save(trace_path());
+#endif
 
 		SDL_Quit();
 	}
+
+	TRenderer m_renderer;
+
+	Timers<TUserState> m_timers;
+
+	RollingTimings m_frame_timings;
+	RollingTimings m_render_timings;
 };
 
 #endif // APPLICATION_H
@@ -6,13 +6,31 @@
 #include "Style.h"
 
 template<int TId, typename TUserState>
-struct ButtonState
+struct ButtonState : public InteractiveControl
 {
 	STATE_PROPERTY(VisualState, state)
 	STATE_PROPERTY(glm::vec2, size)
 	STATE_PROPERTY(glm::vec2, position)
 	STATE_PROPERTY(Callback<TUserState>, on_clicked)
 	STATE_PROPERTY(std::string, text)
+
+	bool is_affected(const RootState &root) const
+	{
+		if (!is_pointer_event(root.event))
+		{
+			return false;
+		}
+
+		const auto pointed = root.is_pointed(make_hit_entry(TId, position, size));
+
+		// Pressed, and maybe clicked
+		if (pointed && root.event.type == SDL_MOUSEBUTTONDOWN)
+		{
+			return true;
+		}
+
+		return state != (pointed ? VisualState::Hover : VisualState::Normal);
+	}
 };
 
 template<Operation TOperation>
@@ -24,12 +42,12 @@ template<>
 struct ButtonLogic<Operation::Initialize>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &button = ButtonState<get_level_v<TContext>, get_user_state_t<TContext>>();
-		const auto &new_context = context_prepend(button, context);
+		auto new_context = context_prepend(button, std::move(context));
 
-		return expand_templates(new_context
+		return expand_templates(std::move(new_context)
 			, get_style_t<TContext>::ButtonStyle::Normal::layout(button)
 			, get_style_t<TContext>::ButtonStyle::Hover::layout(button)
 			, get_style_t<TContext>::ButtonStyle::Pressed::layout(button)
@@ -41,12 +59,12 @@ template<>
 struct ButtonLogic<Operation::Update>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &properties)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &properties)
 	{
-		const auto &new_context =
+		auto new_context =
 			handle_events(
 				calculate_state(
-					repack(context,
+					repack(std::move(context),
 						apply_properties(properties,
 							read_control_state<ButtonState>(context)
 						)
@@ -56,7 +74,7 @@ struct ButtonLogic<Operation::Update>
 
 		const auto &button = read_control_state<ButtonState>(new_context);
 
-		return expand_templates(new_context
+		return expand_templates(std::move(new_context)
 			, get_style_t<TContext>::ButtonStyle::Normal::layout(button)
 			, get_style_t<TContext>::ButtonStyle::Hover::layout(button)
 			, get_style_t<TContext>::ButtonStyle::Pressed::layout(button)
@@ -64,7 +82,7 @@ struct ButtonLogic<Operation::Update>
 	}
 
 	template<typename TContext>
-	static auto handle_events(const TContext &context)
+	static auto handle_events(TContext context)
 	{
 		const auto &root = std::get<RootState>(context.state);
 		const auto &user = read_user_state(context);
@@ -80,37 +98,43 @@ struct ButtonLogic<Operation::Update>
 			return context;
 		}
 
-		const SDL_Rect rect = { (int)button.position.x, (int)button.position.y, (int)button.size.x, (int)button.size.y };
-		const SDL_Point point = { root.event.motion.x, root.event.motion.y };
-
-		if (SDL_PointInRect(&point, &rect))
+		if (root.is_pointed(make_hit_entry(get_level_v<TContext>, button.position, button.size)))
 		{
-			return repack(context, button.on_clicked(user));
+			return repack(std::move(context), button.on_clicked(user));
 		}
 
 		return context;
 	}
 
 	template<typename TContext>
-	static auto calculate_state(const TContext &context)
+	static auto calculate_state(TContext context)
 	{
 		const auto &root = read_root_state(context);
 		const auto &button = read_control_state<ButtonState>(context);
 
-		const SDL_Rect rect = { (int)button.position.x, (int)button.position.y, (int)button.size.x, (int)button.size.y };
-		const SDL_Point point = { root.event.motion.x, root.event.motion.y };
+		// Such as the ticks of timers, which do not move the pointer
+		if (!is_pointer_event(root.event))
+		{
+			return context;
+		}
 
-		if (!SDL_PointInRect(&point, &rect))
+		if (!root.is_pointed(make_hit_entry(get_level_v<TContext>, button.position, button.size)))
 		{
-			return repack(context, button.with_state(VisualState::Normal));
+			// Nothing to do for buttons that were not under the pointer either
+			if (button.state == VisualState::Normal)
+			{
+				return context;
+			}
+
+			return repack(std::move(context), button.with_state(VisualState::Normal));
 		}
 
 		if (root.event.button.type == SDL_MOUSEBUTTONDOWN)
 		{
-			return repack(context, button.with_state(VisualState::Pressed));
+			return repack(std::move(context), button.with_state(VisualState::Pressed));
 		}
 
-		return repack(context, button.with_state(VisualState::Hover));
+		return repack(std::move(context), button.with_state(VisualState::Hover));
 	}
 };
 
@@ -118,13 +142,13 @@ template<>
 struct ButtonLogic<Operation::Draw>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &button = read_control_state<ButtonState>(context);
 
 		if (button.state == VisualState::Hover)
 		{
-			return expand_templates(context
+			return expand_templates(std::move(context)
 				, get_style_t<TContext>::ButtonStyle::Normal::layout(button) | skip
 				, get_style_t<TContext>::ButtonStyle::Hover::layout(button)
 				, get_style_t<TContext>::ButtonStyle::Pressed::layout(button) | skip
@@ -133,14 +157,14 @@ struct ButtonLogic<Operation::Draw>
 
 		if (button.state == VisualState::Pressed)
 		{
-			return expand_templates(context
+			return expand_templates(std::move(context)
 				, get_style_t<TContext>::ButtonStyle::Normal::layout(button) | skip
 				, get_style_t<TContext>::ButtonStyle::Hover::layout(button) | skip
 				, get_style_t<TContext>::ButtonStyle::Pressed::layout(button)
 				);
 		}
 
-		return expand_templates(context
+		return expand_templates(std::move(context)
 			, get_style_t<TContext>::ButtonStyle::Normal::layout(button)
 			, get_style_t<TContext>::ButtonStyle::Hover::layout(button) | skip
 			, get_style_t<TContext>::ButtonStyle::Pressed::layout(button) | skip
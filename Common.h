@@ -9,27 +9,88 @@
 
 #include FT_FREETYPE_H
 
+#include <memory>
+
 #include "Context.h"
 #include "DrawCommand.h"
+#include "GlyphCache.h"
+#include "HitIndex.h"
+#include "TextLayout.h"
+
+// Font and size (in points) used by text, until controls get to choose
+constexpr uint DEFAULT_FONT = 0;
+constexpr const char *DEFAULT_FONT_PATH = "/usr/share/fonts/cantarell/Cantarell-Regular.otf";
+constexpr uint DEFAULT_FONT_SIZE = 11;
 
-constexpr int TEXTURE_SIZE = 128;
+constexpr int SCREEN_WIDTH = 800;
+constexpr int SCREEN_HEIGHT = 600;
 
-struct Glyph
+struct FrameStatistics
 {
-	size_t index;
+	FrameStatistics()
+		: damaged_area(0)
+		, skipped(0)
+		, unchanged(0)
+		, painted(0)
+		, frame_time(0)
+		, layout_time(0)
+		, instances(0)
+		, uploaded_bytes(0)
+		, allocations(0)
+	{
+	}
+
+	// Area that was repainted in the last frame, and its size in pixels
+	STATE_PROPERTY(Bounds, damage)
+	STATE_PROPERTY(float, damaged_area)
+
+	// Frames so far whose events no control reacted to, and which were not
+	// laid out at all
+	STATE_PROPERTY(uint64_t, skipped)
 
-	glm::vec4 bounds;
+	// Frames so far that were laid out, but hashed the same as the one on
+	// screen, and frames that were painted
+	STATE_PROPERTY(uint64_t, unchanged)
+	STATE_PROPERTY(uint64_t, painted)
 
-	long ax; // advance.x
-	long ay; // advance.y
+	// Of the last painted frame, in nanoseconds: all of it, and the layout
+	// passes alone
+	STATE_PROPERTY(uint64_t, frame_time)
+	STATE_PROPERTY(uint64_t, layout_time)
 
-	int offset;
+	// Draw commands of the last painted frame, and what the renderer uploaded
+	// for the last frame it rendered, which might lag behind
+	STATE_PROPERTY(std::size_t, instances)
+	STATE_PROPERTY(std::size_t, uploaded_bytes)
+
+	// Heap allocations made while painting the last frame, when counted (see
+	// Allocations.h)
+	STATE_PROPERTY(uint64_t, allocations)
 };
 
+inline bool is_pointer_event(const SDL_Event &event)
+{
+	return event.type == SDL_MOUSEMOTION
+		|| event.type == SDL_MOUSEBUTTONDOWN
+		|| event.type == SDL_MOUSEBUTTONUP;
+}
+
+// Ids of the controls under the pointer of "event", if there is an index
+inline std::vector<int> find_pointed(const HitIndex *hits, const SDL_Event &event)
+{
+	if (!hits)
+	{
+		return std::vector<int>();
+	}
+
+	return hits->at(glm::ivec2(event.motion.x, event.motion.y));
+}
+
 struct RootState
 {
 	RootState()
 		: focused(-1)
+		, hash(0)
 	{
 	}
 
@@ -37,10 +98,35 @@ struct RootState
 	{
 		RootState copy(*this);
 		copy.event = event;
+		copy.pointed = find_pointed(copy.hits.get(), event);
+
+		return copy;
+	}
+
+	RootState with_hits(std::shared_ptr<const HitIndex> hits) const
+	{
+		RootState copy(*this);
+		copy.hits = std::move(hits);
+		copy.pointed = find_pointed(copy.hits.get(), copy.event);
 
 		return copy;
 	}
 
+	// Whether the pointer of the current event is over the control of "entry".
+	// The index only knows where controls were at the end of the last pass, so
+	// those that have moved since are tested on their own.
+	bool is_pointed(const HitEntry &entry) const
+	{
+		const auto indexed = hits ? hits->find(entry.id) : nullptr;
+
+		if (indexed && *indexed == entry)
+		{
+			return std::binary_search(std::begin(pointed), std::end(pointed), entry.id);
+		}
+
+		return entry.contains(glm::ivec2(event.motion.x, event.motion.y));
+	}
+
 	RootState with_focused(int id) const
 	{
 		RootState copy(*this);
@@ -49,30 +135,59 @@ struct RootState
 		return copy;
 	}
 
-	SDL_Window *window;
-	SDL_GLContext context;
-
 	SDL_Event event;
 
 	int focused;
 
-	GLuint vbo;
-	GLuint ibo;
-	GLuint vao;
-	GLuint commands;
-	GLuint font;
+	// Bounds of the interactive controls, and the ones under the pointer of "event"
+	std::shared_ptr<const HitIndex> hits;
+	std::vector<int> pointed;
 
-	std::array<Glyph, 96> glyphs;
+	// Shared by every copy of the state, as it only ever caches what is derived
+	// from the fonts
+	std::shared_ptr<GlyphCache> glyphs;
+	std::shared_ptr<TextLayoutCache> layouts;
 
 	uint font_height;
 
-	STATE_PROPERTY(uint32_t, hash)
+	STATE_PROPERTY(uint64_t, hash)
+	STATE_PROPERTY(FrameStatistics, statistics)
 };
 
 struct DrawableControl
 {
 };
 
+// Controls that draw from what the Update of other controls left in the root
+// state, like the focus, need every control to be updated before any is drawn.
+// Having one in the layout opts the whole layout out of fused passes.
+struct UnfusedControl
+{
+};
+
+// Controls that only show how the application itself is doing, like the
+// PerformanceOverlay. They are left out of the hash, so that they never make a
+// frame be painted on their own, and are only brought up to date on screen
+// along with the rest.
+struct OverlayControl
+{
+};
+
+// Controls that only ever change their own state, and nothing that is shared
+// between states either, like the glyph cache. Sibling subtrees made of
+// nothing else can be built on different threads.
+struct IsolatedControl
+{
+};
+
+// Controls that react to the pointer, and are kept in the hit index. Their
+// state needs a "position" and a "size", and an "is_affected(root)" telling
+// whether the event of "root" would change anything for them. Events that no
+// control is affected by are not delivered at all.
+struct InteractiveControl
+{
+};
+
 template<typename TUserState>
 using Callback = TUserState (*)(const TUserState &);
 
@@ -107,29 +222,45 @@ TState apply_properties(const TTuple &tuple, const TState &state)
 }
 
 template<template<int, typename> class TControlState, typename TContext>
-auto read_control_state(const TContext &context)
+const auto &read_control_state(const TContext &context)
 {
 	return std::get<TControlState<get_level_v<TContext>, get_user_state_t<TContext>>>(context.state);
 }
 
 template<typename TState>
-auto read_user_state(const TState &state)
+const auto &read_user_state(const TState &state)
 {
 	return std::get<get_user_state_t<TState>>(state);
 }
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
-auto read_user_state(const Context<TOperation, TStyle, TLevel, TState> &context)
+const auto &read_user_state(const Context<TOperation, TStyle, TLevel, TState> &context)
 {
 	return std::get<get_user_state_t<TState>>(context.state);
 }
 
 template<typename TContext>
-auto read_root_state(const TContext &context)
+const auto &read_root_state(const TContext &context)
 {
 	return std::get<RootState>(context.state);
 }
 
+// Level of the control that "T" is the state of, or -1 for anything else in
+// the state, like the user state
+template<typename T>
+struct get_control_id : std::integral_constant<int, -1>
+{
+};
+
+template<template<int, typename> class TControlState, int TId, typename TUserState>
+struct get_control_id<TControlState<TId, TUserState>>
+{
+	static const int value = TId;
+};
+
+template<typename T>
+constexpr int get_control_id_v = get_control_id<T>::value;
+
 template<typename TupleOfIntegralConstant>
 struct as_sequence;
 
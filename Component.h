@@ -12,12 +12,12 @@ struct Component : public Object
 	}
 
 	template<typename TContext>
-	auto build(const TContext &context) const
+	auto build(TContext &&context) const
 	{
 		const auto &state = read_user_state(context);
 		const auto &item = T::layout(state, m_parameters);
 
-		return item.build(context);
+		return item.build(std::forward<TContext>(context));
 	}
 
 	std::tuple<TParameters...> m_parameters;
@@ -2,13 +2,18 @@
 #define CONTEXT_H
 
 #include <tuple>
+#include <utility>
+#include <type_traits>
 
 enum class Operation
 {
 	Noop,
 	Initialize,
 	Update,
-	Draw
+	Draw,
+
+	// Update immediately followed by Draw, for each item in a single traversal
+	Fused
 };
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
@@ -18,31 +23,54 @@ struct Context
 };
 
 template<Operation TOperation, typename TStyle, typename TState>
-Context<TOperation, TStyle, 0, TState> make_context(const TState &state)
+Context<TOperation, TStyle, 0, TState> make_context(TState state)
 {
-	return { state };
+	return { std::move(state) };
 }
 
+// The functions below taking a context by rvalue reference move its state
+// along, instead of copying it
+
 template<Operation TNewOperation, Operation TOperation, typename TStyle, int TLevel, typename TState>
 Context<TNewOperation, TStyle, TLevel, TState> change_operation(const Context<TOperation, TStyle, TLevel, TState> &context)
 {
 	return { context.state };
 }
 
+template<Operation TNewOperation, Operation TOperation, typename TStyle, int TLevel, typename TState>
+Context<TNewOperation, TStyle, TLevel, TState> change_operation(Context<TOperation, TStyle, TLevel, TState> &&context)
+{
+	return { std::move(context.state) };
+}
+
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
 Context<TOperation, TStyle, TLevel + 1, TState> level_up(const Context<TOperation, TStyle, TLevel, TState> &context)
 {
 	return { context.state };
 }
 
+template<Operation TOperation, typename TStyle, int TLevel, typename TState>
+Context<TOperation, TStyle, TLevel + 1, TState> level_up(Context<TOperation, TStyle, TLevel, TState> &&context)
+{
+	return { std::move(context.state) };
+}
+
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
 TState strip_context(const Context<TOperation, TStyle, TLevel, TState> &context)
 {
 	return context.state;
 }
 
+template<Operation TOperation, typename TStyle, int TLevel, typename TState>
+TState strip_context(Context<TOperation, TStyle, TLevel, TState> &&context)
+{
+	return std::move(context.state);
+}
+
 template<typename T>
-struct get_operation;
+struct get_operation : get_operation<std::decay_t<T>>
+{
+};
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
 struct get_operation<Context<TOperation, TStyle, TLevel, TState>>
@@ -54,7 +82,9 @@ template<typename T>
 constexpr Operation get_operation_v = get_operation<T>::value;
 
 template<typename T>
-struct get_level;
+struct get_level : get_level<std::decay_t<T>>
+{
+};
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
 struct get_level<Context<TOperation, TStyle, TLevel, TState>>
@@ -79,7 +109,9 @@ template<typename TContext>
 using get_user_state_t = typename get_user_state<TContext>::type;
 
 template<typename T>
-struct get_style;
+struct get_style : get_style<std::decay_t<T>>
+{
+};
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState>
 struct get_style<Context<TOperation, TStyle, TLevel, TState>>
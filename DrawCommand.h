@@ -7,65 +7,308 @@
 #include <vector>
 #include <tuple>
 #include <numeric>
+#include <cstring>
+#include <cmath>
+#include <limits>
 
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/type_precision.hpp>
 
+// A single axis aligned quad, stored as compactly as possible since one of
+// these is uploaded (and hashed) for every rectangle and glyph on screen
 struct DrawCommand
 {
 	DrawCommand()
-		: matrix(1.0f)
-		, uv(0.0f)
+		: position(0, 0)
+		, size(0, 0)
+		, uv(0, 0, 0, 0)
 		, color(0)
+		, page(0)
 	{
 	}
 
-	STATE_PROPERTY(glm::mat3, matrix)
-	STATE_PROPERTY(glm::vec4, uv)
+	// In whole pixels
+	DrawCommand with_position(const glm::vec2 &position) const
+	{
+		DrawCommand copy(*this);
+		copy.position = glm::i16vec2(glm::round(position));
+
+		return copy;
+	}
+
+	// In whole pixels, where negative sizes are treated as empty
+	DrawCommand with_size(const glm::vec2 &size) const
+	{
+		DrawCommand copy(*this);
+		copy.size = glm::u16vec2(glm::round(glm::max(size, 0.0f)));
+
+		return copy;
+	}
+
+	// Normalized texture coordinates (x, y) and extent (z, w) in the glyph atlas
+	DrawCommand with_uv(const glm::vec4 &uv) const
+	{
+		DrawCommand copy(*this);
+		copy.uv = glm::u16vec4(glm::round(glm::clamp(uv, 0.0f, 1.0f) * 65535.0f));
+
+		return copy;
+	}
+
+	bool textured() const
+	{
+		return uv != glm::u16vec4(0, 0, 0, 0);
+	}
+
+	bool operator ==(const DrawCommand &other) const
+	{
+		return memcmp(this, &other, sizeof(DrawCommand)) == 0;
+	}
+
+	glm::i16vec2 position;
+	glm::u16vec2 size;
+	glm::u16vec4 uv;
+
 	STATE_PROPERTY(uint, color)
+
+	// Atlas page that "uv" refers to
+	STATE_PROPERTY(uint, page)
 };
 
-uint32_t create_hash(uint32_t offset, const DrawCommand &value)
+// Axis aligned, screen space rectangle, with "min" inclusive and "max" exclusive
+struct Bounds
 {
-	const auto begin = reinterpret_cast<const uint8_t *>(&value);
-	const auto end = begin + sizeof(value);
+	Bounds()
+		: min(std::numeric_limits<float>::max())
+		, max(std::numeric_limits<float>::lowest())
+	{
+	}
 
-	return std::accumulate(begin, end, offset, [](uint32_t hash, uint8_t octet)
+	Bounds(const glm::vec2 &min, const glm::vec2 &max)
+		: min(min)
+		, max(max)
 	{
-		return (hash ^ octet) * 16777619;
-	});
+	}
+
+	bool empty() const
+	{
+		return min.x >= max.x || min.y >= max.y;
+	}
+
+	float area() const
+	{
+		return empty() ? 0 : (max.x - min.x) * (max.y - min.y);
+	}
+
+	bool intersects(const Bounds &other) const
+	{
+		return min.x < other.max.x
+			&& min.y < other.max.y
+			&& other.min.x < max.x
+			&& other.min.y < max.y;
+	}
+
+	Bounds united(const Bounds &other) const
+	{
+		return
+		{
+			glm::vec2(std::min(min.x, other.min.x), std::min(min.y, other.min.y)),
+			glm::vec2(std::max(max.x, other.max.x), std::max(max.y, other.max.y))
+		};
+	}
+
+	Bounds intersected(const Bounds &other) const
+	{
+		return
+		{
+			glm::vec2(std::max(min.x, other.min.x), std::max(min.y, other.min.y)),
+			glm::vec2(std::min(max.x, other.max.x), std::min(max.y, other.max.y))
+		};
+	}
+
+	// Expands the bounds to cover every pixel they touch
+	Bounds snapped() const
+	{
+		return
+		{
+			glm::vec2(std::floor(min.x), std::floor(min.y)),
+			glm::vec2(std::ceil(max.x), std::ceil(max.y))
+		};
+	}
+
+	glm::vec2 min;
+	glm::vec2 max;
 };
 
+Bounds get_bounds(const DrawCommand &command)
+{
+	const auto &position = glm::vec2(command.position);
+
+	return { position, position + glm::vec2(command.size) };
+}
+
+Bounds get_bounds(const immutable_vector<DrawCommand> &commands)
+{
+	return std::accumulate(std::begin(commands), std::end(commands), Bounds(), [](const Bounds &bounds, const DrawCommand &command)
+	{
+		return bounds.united(get_bounds(command));
+	});
+}
+
+// The hashing below reads draw commands as a plain sequence of 32 bit words,
+// which only holds as long as the compiler does not insert any padding
+static_assert(sizeof(DrawCommand) == sizeof(glm::i16vec2) + sizeof(glm::u16vec2) + sizeof(glm::u16vec4) + sizeof(uint) * 2, "DrawCommand must not contain padding");
+static_assert(sizeof(DrawCommand) % sizeof(uint32_t) == 0, "DrawCommand must consist of whole words");
+
+constexpr uint64_t HASH_PRIME_1 = 11400714785074694791ull;
+constexpr uint64_t HASH_PRIME_2 = 14029467366897019727ull;
+constexpr uint64_t HASH_PRIME_3 = 1609587929392839161ull;
+constexpr uint64_t HASH_PRIME_4 = 9650029242287828579ull;
+constexpr uint64_t HASH_PRIME_5 = 2870177450012600261ull;
+
+inline uint64_t hash_rotate(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t hash_round(uint64_t hash, uint64_t word)
+{
+	return hash_rotate(hash + word * HASH_PRIME_2, 31) * HASH_PRIME_1;
+}
+
+inline uint64_t hash_avalanche(uint64_t hash)
+{
+	hash = (hash ^ (hash >> 33)) * HASH_PRIME_2;
+	hash = (hash ^ (hash >> 29)) * HASH_PRIME_3;
+
+	return hash ^ (hash >> 32);
+}
+
+inline uint64_t hash_load(const uint8_t *data)
+{
+	uint64_t word;
+	memcpy(&word, data, sizeof(word));
+
+	return word;
+}
+
+// xxHash64 style hash, consuming 32 bytes per iteration through four independent
+// lanes so that the multiplications can be pipelined (or vectorized) by the CPU
+inline uint64_t hash_words(const uint8_t *data, std::size_t size)
+{
+	const auto end = data + size;
+
+	uint64_t hash = HASH_PRIME_5 + size;
+
+	if (size >= 32)
+	{
+		uint64_t lanes[] =
+		{
+			HASH_PRIME_1 + HASH_PRIME_2,
+			HASH_PRIME_2,
+			0,
+			0 - HASH_PRIME_1
+		};
+
+		for (; data + 32 <= end; data += 32)
+		{
+			lanes[0] = hash_round(lanes[0], hash_load(data));
+			lanes[1] = hash_round(lanes[1], hash_load(data + 8));
+			lanes[2] = hash_round(lanes[2], hash_load(data + 16));
+			lanes[3] = hash_round(lanes[3], hash_load(data + 24));
+		}
+
+		hash = size
+			+ hash_rotate(lanes[0], 1)
+			+ hash_rotate(lanes[1], 7)
+			+ hash_rotate(lanes[2], 12)
+			+ hash_rotate(lanes[3], 18);
+	}
+
+	for (; data + 8 <= end; data += 8)
+	{
+		hash = hash_rotate(hash ^ hash_round(0, hash_load(data)), 27) * HASH_PRIME_1 + HASH_PRIME_4;
+	}
+
+	if (data + 4 <= end)
+	{
+		uint32_t word;
+		memcpy(&word, data, sizeof(word));
+
+		hash = hash_rotate(hash ^ (word * HASH_PRIME_1), 23) * HASH_PRIME_2 + HASH_PRIME_3;
+	}
+
+	return hash_avalanche(hash);
+}
+
+inline uint64_t hash_draw_commands(const immutable_vector<DrawCommand> &commands)
+{
+	if (commands.empty())
+	{
+		return 0;
+	}
+
+	return hash_words(reinterpret_cast<const uint8_t *>(commands.data()), commands.size() * sizeof(DrawCommand));
+}
+
+inline uint64_t combine_hash(uint64_t hash, uint64_t value)
+{
+	return hash_rotate(hash ^ hash_round(0, value), 27) * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+// Declares the draw commands of a drawable control state, along with a hash of
+// them that is only recomputed when the commands are replaced. The commands are
+// shared between copies of the state, so copying it does not copy them.
+#define DRAW_COMMANDS_PROPERTY \
+auto with_draw_commands(const std::vector<DrawCommand> &draw_commands) const\
+{\
+	std::decay_t<decltype(*this)> copy(*this);\
+	copy.draw_commands = immutable_vector<DrawCommand>(draw_commands);\
+	copy.hash = hash_draw_commands(copy.draw_commands);\
+\
+	return copy;\
+}\
+\
+immutable_vector<DrawCommand> draw_commands;\
+uint64_t hash;\
+
 template<typename TTuple, size_t TIndex>
 struct compute_hash_impl
 {
-	static uint32_t value(const TTuple &tuple)
+	static uint64_t value(const TTuple &tuple)
 	{
 		const auto &hash = compute_hash_impl<TTuple, TIndex - 1>::value(tuple);
 		const auto &control = std::get<TIndex - 1>(tuple);
 
-		return std::accumulate(std::begin(control.draw_commands)
-			, std::end(control.draw_commands)
-			, hash
-			, &create_hash
-			);
+		return combine_hash(hash, control.hash);
 	}
 };
 
 template<typename TTuple>
 struct compute_hash_impl<TTuple, 0>
 {
-	static uint32_t value(const TTuple &)
+	static uint64_t value(const TTuple &)
 	{
-		return 2166136261u;
+		return HASH_PRIME_5;
 	}
 };
 
 template<typename TTuple>
-uint32_t compute_hash(const TTuple &tuple)
+uint64_t compute_hash(const TTuple &tuple)
 {
 	return compute_hash_impl<TTuple, std::tuple_size_v<TTuple>>::value(tuple);
 }
 
+// Same as compute_hash, but only over the controls at "TIndex"
+template<typename TTuple, std::size_t ...TIndex>
+uint64_t compute_hash(const TTuple &tuple, std::index_sequence<TIndex...>)
+{
+	auto hash = HASH_PRIME_5;
+
+	((hash = combine_hash(hash, std::get<TIndex>(tuple).hash)), ...);
+
+	return hash;
+}
+
 template<typename TControl>
 auto get_draw_command(const TControl &control)
 {
@@ -84,4 +327,92 @@ auto extract_draw_commands(const TTuple &tuple)
 	return extract_draw_commands(tuple, std::make_index_sequence<std::tuple_size_v<TTuple>>());
 }
 
+template<typename TTuple, std::size_t ...TIndex>
+std::size_t count_draw_commands(const TTuple &tuple, std::index_sequence<TIndex...>)
+{
+	return (std::get<TIndex>(tuple).draw_commands.size() + ... + 0);
+}
+
+template<typename TTuple>
+std::size_t count_draw_commands(const TTuple &tuple)
+{
+	return count_draw_commands(tuple, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+}
+
+template<typename TControl>
+DrawCommand *write_draw_command(const TControl &control, DrawCommand *target)
+{
+	return std::copy(std::begin(control.draw_commands), std::end(control.draw_commands), target);
+}
+
+template<typename TControl>
+DrawCommand *write_draw_command(const TControl &control, DrawCommand *target, const Bounds &damage)
+{
+	return std::copy_if(std::begin(control.draw_commands), std::end(control.draw_commands), target, [&](const DrawCommand &command)
+	{
+		return get_bounds(command).intersects(damage);
+	});
+}
+
+// Same as extract_draw_commands, but writes straight into "target" (typically mapped
+// GPU memory) instead of going through an intermediate vector
+template<typename TTuple, std::size_t ...TIndex>
+DrawCommand *write_draw_commands(const TTuple &tuple, DrawCommand *target, std::index_sequence<TIndex...>)
+{
+	((target = write_draw_command(std::get<std::tuple_size_v<TTuple> - (TIndex + 1)>(tuple), target)), ...);
+
+	return target;
+}
+
+template<typename TTuple>
+DrawCommand *write_draw_commands(const TTuple &tuple, DrawCommand *target)
+{
+	return write_draw_commands(tuple, target, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+}
+
+// Only writes the commands intersecting "damage", which are the only ones
+// needed to repaint that area
+template<typename TTuple, std::size_t ...TIndex>
+DrawCommand *write_draw_commands(const TTuple &tuple, DrawCommand *target, const Bounds &damage, std::index_sequence<TIndex...>)
+{
+	((target = write_draw_command(std::get<std::tuple_size_v<TTuple> - (TIndex + 1)>(tuple), target, damage)), ...);
+
+	return target;
+}
+
+template<typename TTuple>
+DrawCommand *write_draw_commands(const TTuple &tuple, DrawCommand *target, const Bounds &damage)
+{
+	return write_draw_commands(tuple, target, damage, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+}
+
+template<typename TControl>
+Bounds get_damage(const TControl &previous, const TControl &current)
+{
+	if (previous.hash == current.hash)
+	{
+		return Bounds();
+	}
+
+	return get_bounds(previous.draw_commands).united(get_bounds(current.draw_commands));
+}
+
+// Area that needs to be repainted for the screen to go from showing "previous" to showing "current"
+template<typename TTuple, std::size_t ...TIndex>
+Bounds compute_damage(const TTuple &previous, const TTuple &current, std::index_sequence<TIndex...>)
+{
+	const std::initializer_list<Bounds> damages = { Bounds(), get_damage(std::get<TIndex>(previous), std::get<TIndex>(current))... };
+
+	return std::accumulate(std::begin(damages), std::end(damages), Bounds(), [](const Bounds &damage, const Bounds &bounds)
+	{
+		return damage.united(bounds);
+	});
+}
+
+template<typename TTuple>
+Bounds compute_damage(const TTuple &previous, const TTuple &current)
+{
+	return compute_damage(previous, current, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+}
+
 #endif // DRAWCOMMAND_H
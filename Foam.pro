@@ -5,7 +5,7 @@
 TEMPLATE = app
 TARGET = Foam
 INCLUDEPATH += . /usr/include/SDL2
-CONFIG += c++17 link_pkgconfig
+CONFIG += c++17 link_pkgconfig thread
 CONFIG -= qt
 
 # The following define makes your compiler warn you if you use any
@@ -14,6 +14,10 @@ CONFIG -= qt
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Records how long every phase of a frame takes, and writes it out as a Chrome
+# trace when the application exits
+#DEFINES += FOAM_TRACE
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -26,6 +30,13 @@ LIBS += -lSDL2 -lSDL2main -lGLEW -lGL
 
 HEADERS += \
     Algorithms.h \
+    Allocations.h \
+    GLRenderer.h \
+    GlyphCache.h \
+    GpuTimer.h \
+    HitIndex.h \
+    SoftwareRenderer.h \
+    StreamBuffer.h \
     DrawCommand.h \
     Repack.h \
     Properties.h \
@@ -34,13 +45,28 @@ HEADERS += \
     Context.h \
     Rectangle.h \
     MouseArea.h \
+    Parallel.h \
+    Island.h \
     Item.h \
+    LruCache.h \
+    MappedFile.h \
+    MemoComponent.h \
+    PerformanceOverlay.h \
+    PersistentMap.h \
+    PersistentVector.h \
     Component.h \
     Application.h \
     Style.h \
     DefaultStyle.h \
     Text.h \
     TextBox.h \
+    TextLayout.h \
+    ThreadPool.h \
+    ThreadedRenderer.h \
+    Trace.h \
+    Timers.h \
+    Timings.h \
+    Utf8.h \
     Vector.h
 
 DISTFILES += \
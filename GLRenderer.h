@@ -0,0 +1,290 @@
+#ifndef GLRENDERER_H
+#define GLRENDERER_H
+
+#include "Common.h"
+#include "GpuTimer.h"
+#include "StreamBuffer.h"
+#include "Trace.h"
+
+#include "incbin.h"
+
+INCBIN(VertexShader, "shader.vert");
+INCBIN(FragmentShader, "shader.frag");
+
+GLuint create_program()
+{
+	const auto program = glCreateProgram();
+
+	const auto vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	const auto fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+	const auto *vs_source = reinterpret_cast<const GLchar *>(&gVertexShaderData);
+	const auto *fs_source = reinterpret_cast<const GLchar *>(&gFragmentShaderData);
+
+	glShaderSource(vertexShader, 1, &vs_source, reinterpret_cast<const GLint *>(&gVertexShaderSize));
+	glShaderSource(fragmentShader, 1, &fs_source, reinterpret_cast<const GLint *>(&gFragmentShaderSize));
+
+	glCompileShader(vertexShader);
+	glCompileShader(fragmentShader);
+
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+
+	glLinkProgram(program);
+
+	return program;
+}
+
+// Renders draw commands to an SDL window through OpenGL, with one instanced
+// draw call per frame
+class GLRenderer
+{
+	public:
+		GLRenderer()
+			: m_window(nullptr)
+			, m_context(nullptr)
+			, m_program(0)
+			, m_vbo(0)
+			, m_ibo(0)
+			, m_font(0)
+			, m_font_pages(0)
+			, m_framebuffer(0)
+			, m_canvas(0)
+			, m_uploading(0)
+			, m_uploaded(0)
+		{
+		}
+
+		void create()
+		{
+			SDL_InitSubSystem(SDL_INIT_VIDEO);
+
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+			SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+			m_window = SDL_CreateWindow("Foam", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_OPENGL);
+			m_context = SDL_GL_CreateContext(m_window);
+
+			glewInit();
+
+			SDL_GL_SetSwapInterval(1);
+
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			glActiveTexture(GL_TEXTURE0);
+
+			glGenTextures(1, &m_canvas);
+			glBindTexture(GL_TEXTURE_2D, m_canvas);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCREEN_WIDTH, SCREEN_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+			glGenFramebuffers(1, &m_framebuffer);
+			glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_canvas, 0);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+			// One layer per atlas page, allocated once there are glyphs to upload
+			glGenTextures(1, &m_font);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, m_font);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, ATLAS_PAGE_SIZE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+			m_program = create_program();
+
+			glClearColor(0.f, 0.f, 0.f, 1.f);
+
+			glGenBuffers(1, &m_vbo);
+			glGenBuffers(1, &m_ibo);
+
+			glUseProgram(m_program);
+
+			static const GLfloat vertex_data[] =
+			{
+				0.f, 0.f,
+				1.f, 0.f,
+				1.f, 1.f,
+				0.f, 1.f
+			};
+
+			glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_data), vertex_data, GL_STATIC_DRAW);
+
+			static const GLuint index_data[] =
+			{
+				0, 1, 2, 3
+			};
+
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(index_data), index_data, GL_STATIC_DRAW);
+
+			m_stream.create(m_vbo, m_ibo);
+			m_gpu_timer.create();
+		}
+
+		void destroy()
+		{
+			m_gpu_timer.destroy();
+			m_stream.destroy();
+
+			glDeleteBuffers(1, &m_vbo);
+			glDeleteBuffers(1, &m_ibo);
+
+			glDeleteFramebuffers(1, &m_framebuffer);
+			glDeleteTextures(1, &m_canvas);
+			glDeleteTextures(1, &m_font);
+
+			glUseProgram(0);
+			glDeleteProgram(m_program);
+
+			SDL_GL_DeleteContext(m_context);
+			SDL_DestroyWindow(m_window);
+		}
+
+		// Makes the GL context current on the calling thread
+		void acquire()
+		{
+			SDL_GL_MakeCurrent(m_window, m_context);
+		}
+
+		// Lets go of the GL context, so that another thread can acquire it
+		void release()
+		{
+			SDL_GL_MakeCurrent(m_window, nullptr);
+		}
+
+		// Uploads the parts of the atlas pages that have changed since last time,
+		// from a GlyphCache or anything else that can flush pages the same way
+		template<typename TGlyphs>
+		void upload_glyphs(TGlyphs &glyphs)
+		{
+			glBindTexture(GL_TEXTURE_2D_ARRAY, m_font);
+
+			if (glyphs.page_count() > m_font_pages)
+			{
+				m_font_pages = std::max(glyphs.page_count(), m_font_pages * 2);
+
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, GLsizei(m_font_pages), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+				glyphs.invalidate();
+			}
+
+			glyphs.flush([this](uint page, const uint8_t *pixels, const Bounds &dirty)
+			{
+				const auto x = int(dirty.min.x);
+				const auto y = int(dirty.min.y);
+
+				m_uploading += std::size_t(dirty.area());
+
+				glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, GLint(page), int(dirty.max.x) - x, int(dirty.max.y) - y, 1, GL_RED, GL_UNSIGNED_BYTE, pixels + y * ATLAS_PAGE_SIZE + x);
+			});
+		}
+
+		// Repaints the "damage" area of the canvas with the draw commands of "drawables"
+		template<typename TDrawables>
+		void draw(const TDrawables &drawables, const Bounds &damage)
+		{
+			if (damage.empty())
+			{
+				return;
+			}
+
+			glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(int(damage.min.x), SCREEN_HEIGHT - int(damage.max.y), int(damage.max.x - damage.min.x), int(damage.max.y - damage.min.y));
+
+			m_gpu_timer.begin(GpuPhase::Clear);
+
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			m_gpu_timer.end();
+
+			const auto count = traced("upload_commands", [&]
+			{
+				return m_stream.upload(count_draw_commands(drawables), [&](DrawCommand *target)
+				{
+					return write_draw_commands(drawables, target, damage);
+				});
+			});
+
+			m_gpu_timer.begin(GpuPhase::Draw);
+
+			glDrawElementsInstanced(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, 0, GLsizei(count));
+
+			m_gpu_timer.end();
+
+			m_uploading += count * sizeof(DrawCommand);
+
+			m_stream.fence();
+
+			glDisable(GL_SCISSOR_TEST);
+		}
+
+		void present()
+		{
+			m_gpu_timer.begin(GpuPhase::Present);
+
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+			glBlitFramebuffer(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+			{
+				TRACE_SCOPE("swap");
+
+				SDL_GL_SwapWindow(m_window);
+			}
+
+			m_gpu_timer.end();
+			m_gpu_timer.next_frame();
+
+			m_uploaded = m_uploading;
+			m_uploading = 0;
+		}
+
+		// Rolling statistics of how long the GPU took over the last frames,
+		// lagging a few frames behind
+		GpuTimings gpu_timings() const
+		{
+			return m_gpu_timer.timings();
+		}
+
+		// Bytes of glyphs and draw commands uploaded for the last frame
+		std::size_t uploaded_bytes() const
+		{
+			return m_uploaded;
+		}
+
+	private:
+		SDL_Window *m_window;
+		SDL_GLContext m_context;
+
+		GLuint m_program;
+		GLuint m_vbo;
+		GLuint m_ibo;
+		GLuint m_font;
+
+		std::size_t m_font_pages;
+
+		// Off screen copy of the window contents, which is what makes it possible
+		// to only repaint the damaged parts of it
+		GLuint m_framebuffer;
+		GLuint m_canvas;
+
+		StreamBuffer m_stream;
+
+		GpuTimer m_gpu_timer;
+
+		// Uploaded for the frame being painted, and for the last one presented
+		std::size_t m_uploading;
+		std::size_t m_uploaded;
+};
+
+#endif // GLRENDERER_H
@@ -0,0 +1,920 @@
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+#include <freetype2/ft2build.h>
+
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "DrawCommand.h"
+#include "MappedFile.h"
+
+// Width and height of every atlas page, in pixels
+constexpr int ATLAS_PAGE_SIZE = 512;
+constexpr std::size_t ATLAS_PAGE_BYTES = ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE;
+
+// How much memory the atlas pages may take up before the least recently used
+// page is recycled
+constexpr std::size_t DEFAULT_GLYPH_BUDGET = 4 * ATLAS_PAGE_BYTES;
+
+constexpr uint GLYPH_DPI = 96;
+
+// Empty space kept between glyphs in the atlas
+constexpr int GLYPH_PADDING = 1;
+
+constexpr std::size_t NO_PAGE = std::numeric_limits<std::size_t>::max();
+
+// Returned by GlyphCache::add_font for fonts that could not be read
+constexpr uint NO_FONT = std::numeric_limits<uint>::max();
+
+// Identifies glyph cache files, and the version of their layout
+constexpr uint32_t GLYPH_CACHE_MAGIC = 0x4d414f46;
+constexpr uint32_t GLYPH_CACHE_VERSION = 1;
+
+struct Glyph
+{
+	glm::vec4 bounds; // x, y, width and height in the atlas page
+
+	uint page;
+
+	long ax; // advance.x
+	long ay; // advance.y
+
+	int offset;
+};
+
+struct GlyphKey
+{
+	uint font;
+	uint size;
+
+	char32_t codepoint;
+
+	bool operator ==(const GlyphKey &other) const
+	{
+		return font == other.font
+			&& size == other.size
+			&& codepoint == other.codepoint;
+	}
+};
+
+struct GlyphKeyHash
+{
+	std::size_t operator ()(const GlyphKey &key) const
+	{
+		return std::size_t(combine_hash(combine_hash(key.font, key.size), key.codepoint));
+	}
+};
+
+struct GlyphRecord
+{
+	GlyphKey key;
+	Glyph glyph;
+};
+
+struct SkylineNode
+{
+	int x;
+	int y;
+	int width;
+};
+
+// Written at the start of a glyph cache file. It is followed by the pixels of
+// every page, the glyph records, the number of skyline nodes of every page
+// and finally the nodes themselves.
+struct GlyphCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+
+	// What the file is keyed by, and must match for it to be used
+	uint64_t fonts;
+	uint32_t size;
+	uint32_t dpi;
+	uint32_t page_size;
+	uint32_t record_size;
+
+	uint32_t line_height;
+	uint32_t glyph_count;
+	uint32_t page_count;
+	uint32_t node_count;
+};
+
+// Packs rectangles into a page by keeping track of the top edge ("skyline") of
+// everything placed so far, putting every new rectangle as low as it fits
+class SkylinePacker
+{
+	public:
+		SkylinePacker()
+		{
+			clear();
+		}
+
+		SkylinePacker(const std::vector<SkylineNode> &nodes)
+			: m_nodes(nodes)
+		{
+		}
+
+		const std::vector<SkylineNode> &nodes() const
+		{
+			return m_nodes;
+		}
+
+		void clear()
+		{
+			m_nodes = { { 0, 0, ATLAS_PAGE_SIZE } };
+		}
+
+		bool allocate(const glm::ivec2 &size, glm::ivec2 &position)
+		{
+			auto best = m_nodes.size();
+			auto best_y = ATLAS_PAGE_SIZE;
+			auto best_width = ATLAS_PAGE_SIZE;
+
+			for (std::size_t i = 0; i < m_nodes.size(); i++)
+			{
+				const auto y = fit(i, size);
+
+				if (y < 0)
+				{
+					continue;
+				}
+
+				if (y < best_y || (y == best_y && m_nodes[i].width < best_width))
+				{
+					best = i;
+					best_y = y;
+					best_width = m_nodes[i].width;
+				}
+			}
+
+			if (best == m_nodes.size())
+			{
+				return false;
+			}
+
+			position = glm::ivec2(m_nodes[best].x, best_y);
+
+			m_nodes.insert(std::begin(m_nodes) + long(best), { position.x, position.y + size.y, size.x });
+
+			// Cut away the parts of the following nodes now covered by the new one
+			for (auto i = best + 1; i < m_nodes.size();)
+			{
+				const auto &previous = m_nodes[i - 1];
+				const auto overlap = previous.x + previous.width - m_nodes[i].x;
+
+				if (overlap <= 0)
+				{
+					break;
+				}
+
+				m_nodes[i].x += overlap;
+				m_nodes[i].width -= overlap;
+
+				if (m_nodes[i].width > 0)
+				{
+					break;
+				}
+
+				m_nodes.erase(std::begin(m_nodes) + long(i));
+			}
+
+			for (std::size_t i = 1; i < m_nodes.size();)
+			{
+				if (m_nodes[i - 1].y == m_nodes[i].y)
+				{
+					m_nodes[i - 1].width += m_nodes[i].width;
+					m_nodes.erase(std::begin(m_nodes) + long(i));
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		// Returns the lowest y at which "size" fits when placed at the left edge
+		// of node "index", or -1 if it does not fit there at all
+		int fit(std::size_t index, const glm::ivec2 &size) const
+		{
+			if (m_nodes[index].x + size.x > ATLAS_PAGE_SIZE)
+			{
+				return -1;
+			}
+
+			auto y = 0;
+
+			for (auto i = index, remaining = std::size_t(size.x); remaining > 0; i++)
+			{
+				y = std::max(y, m_nodes[i].y);
+
+				if (y + size.y > ATLAS_PAGE_SIZE)
+				{
+					return -1;
+				}
+
+				remaining -= std::min(remaining, std::size_t(m_nodes[i].width));
+			}
+
+			return y;
+		}
+
+		std::vector<SkylineNode> m_nodes;
+};
+
+struct AtlasPage
+{
+	AtlasPage()
+		: pixels(ATLAS_PAGE_BYTES)
+		, mapped(nullptr)
+		, last_used(0)
+	{
+	}
+
+	AtlasPage(const uint8_t *mapped, const std::vector<SkylineNode> &nodes)
+		: mapped(mapped)
+		, packer(nodes)
+		, last_used(0)
+	{
+	}
+
+	const uint8_t *data() const
+	{
+		return mapped ? mapped : pixels.data();
+	}
+
+	// Pages loaded from a cache file are read straight from the mapping, until
+	// something needs to be written to them
+	uint8_t *writable()
+	{
+		if (mapped)
+		{
+			pixels.assign(mapped, mapped + ATLAS_PAGE_BYTES);
+			mapped = nullptr;
+		}
+
+		return pixels.data();
+	}
+
+	std::vector<uint8_t> pixels;
+
+	const uint8_t *mapped;
+
+	SkylinePacker packer;
+
+	// Glyphs living in this page, which are forgotten if it is recycled
+	std::vector<GlyphKey> glyphs;
+
+	// Part of the page that has changed since it was last uploaded
+	Bounds dirty;
+
+	uint64_t last_used;
+};
+
+// Rasterizes glyphs on demand, keyed by font, size and code point, and packs
+// them into atlas pages. Draw commands refer to glyphs by page and position,
+// so whenever a page is recycled the generation is bumped, telling controls
+// that their draw commands might no longer be valid.
+//
+// FreeType is only loaded once a glyph actually needs to be rasterized, so
+// that starting from a cache file does not have to touch it at all.
+class GlyphCache
+{
+	public:
+		GlyphCache(std::size_t budget = DEFAULT_GLYPH_BUDGET)
+			: m_library(nullptr)
+			, m_budget(budget)
+			, m_frame(1)
+			, m_generation(0)
+		{
+		}
+
+		GlyphCache(const GlyphCache &) = delete;
+		GlyphCache &operator =(const GlyphCache &) = delete;
+
+		~GlyphCache()
+		{
+			for (const auto &font : m_fonts)
+			{
+				if (font.face)
+				{
+					FT_Done_Face(font.face);
+				}
+			}
+
+			if (m_library)
+			{
+				FT_Done_FreeType(m_library);
+			}
+		}
+
+		// Returns the id of the font, or NO_FONT if it could not be read. Code
+		// points missing from a font are looked up in the other fonts, in the
+		// order they were added.
+		uint add_font(const std::string &path)
+		{
+			const MappedFile file(path);
+
+			if (!file.data())
+			{
+				return NO_FONT;
+			}
+
+			m_fonts.push_back({ path, hash_words(file.data(), file.size()), nullptr, 0, false });
+
+			return uint(m_fonts.size() - 1);
+		}
+
+		uint line_height(uint font, uint size)
+		{
+			const auto key = combine_hash(font, size);
+			const auto existing = m_line_heights.find(key);
+
+			if (existing != std::end(m_line_heights))
+			{
+				return existing->second;
+			}
+
+			const auto handle = select(font, size);
+
+			if (!handle)
+			{
+				return 0;
+			}
+
+			const auto height = uint(handle->size->metrics.height >> 6);
+
+			m_line_heights.emplace(key, height);
+
+			return height;
+		}
+
+		Glyph get(uint font, uint size, char32_t codepoint)
+		{
+			const GlyphKey key { font, size, codepoint };
+
+			const auto existing = m_glyphs.find(key);
+
+			if (existing != std::end(m_glyphs))
+			{
+				touch(existing->second);
+
+				return existing->second;
+			}
+
+			const auto &glyph = rasterize(key);
+
+			m_glyphs.emplace(key, glyph);
+
+			return glyph;
+		}
+
+		// Marks "page" as used by the current frame
+		void touch(uint page)
+		{
+			m_pages[page].last_used = m_frame;
+		}
+
+		// Rasterizes the code points in [first, last) ahead of time, so that they
+		// end up in the atlas before the first frame and get uploaded in one go
+		void prewarm(uint font, uint size, char32_t first, char32_t last)
+		{
+			for (auto codepoint = first; codepoint < last; codepoint++)
+			{
+				get(font, size, codepoint);
+			}
+		}
+
+		// Pages used after this are considered in use by the current frame, and
+		// will not be recycled until the next one
+		void begin_frame()
+		{
+			m_frame++;
+		}
+
+		uint64_t generation() const
+		{
+			return m_generation;
+		}
+
+		std::size_t page_count() const
+		{
+			return m_pages.size();
+		}
+
+		// Marks every page as needing a full upload
+		void invalidate()
+		{
+			for (auto &page : m_pages)
+			{
+				page.dirty = Bounds(glm::vec2(0, 0), glm::vec2(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE));
+			}
+		}
+
+		// Hands the changed part of every page to "uploader"
+		template<typename TUploader>
+		void flush(const TUploader &uploader)
+		{
+			for (std::size_t i = 0; i < m_pages.size(); i++)
+			{
+				auto &page = m_pages[i];
+
+				if (page.dirty.empty())
+				{
+					continue;
+				}
+
+				uploader(uint(i), page.data(), page.dirty);
+
+				page.dirty = Bounds();
+			}
+		}
+
+		// Replaces the (empty) cache with the one stored at "path", as long as it was
+		// created from the same fonts, at the same size and DPI
+		bool load(const std::string &path, uint font, uint size)
+		{
+			if (!m_pages.empty())
+			{
+				return false;
+			}
+
+			MappedFile file(path);
+
+			GlyphCacheHeader header;
+
+			if (file.size() < sizeof(header))
+			{
+				return false;
+			}
+
+			memcpy(&header, file.data(), sizeof(header));
+
+			if (header.magic != GLYPH_CACHE_MAGIC
+				|| header.version != GLYPH_CACHE_VERSION
+				|| header.fonts != fonts_hash()
+				|| header.size != size
+				|| header.dpi != GLYPH_DPI
+				|| header.page_size != ATLAS_PAGE_SIZE
+				|| header.record_size != sizeof(GlyphRecord))
+			{
+				return false;
+			}
+
+			// The counts are 32 bit, so none of this can overflow
+			const auto expected = sizeof(header)
+				+ header.page_count * ATLAS_PAGE_BYTES
+				+ header.glyph_count * sizeof(GlyphRecord)
+				+ header.page_count * sizeof(uint32_t)
+				+ header.node_count * sizeof(SkylineNode);
+
+			if (expected != file.size())
+			{
+				return false;
+			}
+
+			const auto pages = file.data() + sizeof(header);
+			const auto records = pages + header.page_count * ATLAS_PAGE_BYTES;
+			const auto counts = records + header.glyph_count * sizeof(GlyphRecord);
+			const auto nodes = counts + header.page_count * sizeof(uint32_t);
+
+			// Anything that does not add up means that the file is stale or corrupt,
+			// in which case the caller starts from scratch
+			const auto discard = [this]
+			{
+				m_pages.clear();
+				m_glyphs.clear();
+
+				return false;
+			};
+
+			for (std::size_t i = 0, first = 0; i < header.page_count; i++)
+			{
+				uint32_t count;
+				memcpy(&count, counts + i * sizeof(count), sizeof(count));
+
+				if (count == 0 || count > header.node_count - first)
+				{
+					return discard();
+				}
+
+				std::vector<SkylineNode> skyline(count);
+
+				memcpy(skyline.data(), nodes + first * sizeof(SkylineNode), count * sizeof(SkylineNode));
+
+				if (!valid(skyline))
+				{
+					return discard();
+				}
+
+				m_pages.emplace_back(pages + i * ATLAS_PAGE_BYTES, skyline);
+
+				first += count;
+			}
+
+			for (std::size_t i = 0; i < header.glyph_count; i++)
+			{
+				GlyphRecord record;
+				memcpy(&record, records + i * sizeof(record), sizeof(record));
+
+				if (record.glyph.bounds.z > 0 && record.glyph.bounds.w > 0)
+				{
+					if (record.glyph.page >= m_pages.size() || !valid(record.glyph.bounds))
+					{
+						return discard();
+					}
+
+					m_pages[record.glyph.page].glyphs.push_back(record.key);
+				}
+
+				m_glyphs.emplace(record.key, record.glyph);
+			}
+
+			m_line_heights.emplace(combine_hash(font, size), header.line_height);
+			m_mapped = std::move(file);
+
+			invalidate();
+
+			return true;
+		}
+
+		// Writes the whole cache to "path", keyed by the fonts, "size" and DPI
+		void save(const std::string &path, uint font, uint size)
+		{
+			if (path.empty())
+			{
+				return;
+			}
+
+			std::vector<GlyphRecord> records;
+			std::vector<uint32_t> counts;
+			std::vector<SkylineNode> nodes;
+
+			for (const auto &glyph : m_glyphs)
+			{
+				records.push_back({ glyph.first, glyph.second });
+			}
+
+			for (const auto &page : m_pages)
+			{
+				const auto &skyline = page.packer.nodes();
+
+				counts.push_back(uint32_t(skyline.size()));
+				nodes.insert(std::end(nodes), std::begin(skyline), std::end(skyline));
+			}
+
+			const GlyphCacheHeader header
+			{
+				GLYPH_CACHE_MAGIC,
+				GLYPH_CACHE_VERSION,
+
+				fonts_hash(),
+				size,
+				GLYPH_DPI,
+				ATLAS_PAGE_SIZE,
+				sizeof(GlyphRecord),
+
+				line_height(font, size),
+				uint32_t(records.size()),
+				uint32_t(m_pages.size()),
+				uint32_t(nodes.size()),
+			};
+
+			// Written next to the final file and then moved into place, so that a
+			// partially written cache is never picked up
+			const auto &temporary = path + ".tmp";
+
+			std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+
+			stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+			for (const auto &page : m_pages)
+			{
+				stream.write(reinterpret_cast<const char *>(page.data()), ATLAS_PAGE_BYTES);
+			}
+
+			stream.write(reinterpret_cast<const char *>(records.data()), std::streamsize(records.size() * sizeof(GlyphRecord)));
+			stream.write(reinterpret_cast<const char *>(counts.data()), std::streamsize(counts.size() * sizeof(uint32_t)));
+			stream.write(reinterpret_cast<const char *>(nodes.data()), std::streamsize(nodes.size() * sizeof(SkylineNode)));
+			stream.close();
+
+			if (stream)
+			{
+				std::rename(temporary.c_str(), path.c_str());
+			}
+			else
+			{
+				std::remove(temporary.c_str());
+			}
+		}
+
+	private:
+		struct Font
+		{
+			std::string path;
+			uint64_t hash;
+
+			FT_Face face;
+			uint size;
+
+			// Whether FreeType failed to load the face, so that it is only tried once
+			bool failed;
+		};
+
+		uint64_t fonts_hash() const
+		{
+			return std::accumulate(std::begin(m_fonts), std::end(m_fonts), HASH_PRIME_5, [](uint64_t hash, const Font &font)
+			{
+				return combine_hash(hash, font.hash);
+			});
+		}
+
+		// Returns the face of "font", loading it the first time, or nullptr if it
+		// does not exist or FreeType could not load it
+		FT_Face face(uint font)
+		{
+			if (font >= m_fonts.size())
+			{
+				return nullptr;
+			}
+
+			auto &selected = m_fonts[font];
+
+			if (!selected.face && !selected.failed)
+			{
+				if (!m_library && FT_Init_FreeType(&m_library))
+				{
+					m_library = nullptr;
+
+					return nullptr;
+				}
+
+				if (FT_New_Face(m_library, selected.path.c_str(), 0, &selected.face))
+				{
+					selected.face = nullptr;
+					selected.failed = true;
+				}
+			}
+
+			return selected.face;
+		}
+
+		FT_Face select(uint font, uint size)
+		{
+			const auto handle = face(font);
+
+			if (!handle)
+			{
+				return nullptr;
+			}
+
+			auto &selected = m_fonts[font];
+
+			if (selected.size != size)
+			{
+				if (FT_Set_Char_Size(handle, 0, FT_F26Dot6(size * 64), GLYPH_DPI, GLYPH_DPI))
+				{
+					return nullptr;
+				}
+
+				selected.size = size;
+			}
+
+			return handle;
+		}
+
+		// Picks the font to rasterize "codepoint" with, and its glyph index in it.
+		// Fonts that failed to load are skipped, and nullptr is returned if none
+		// of them did.
+		FT_Face select(uint font, uint size, char32_t codepoint, FT_UInt &index)
+		{
+			const auto primary = face(font);
+
+			if (primary)
+			{
+				index = FT_Get_Char_Index(primary, codepoint);
+
+				if (index)
+				{
+					return select(font, size);
+				}
+			}
+
+			for (uint fallback = 0; fallback < m_fonts.size(); fallback++)
+			{
+				const auto handle = face(fallback);
+
+				if (!handle)
+				{
+					continue;
+				}
+
+				index = FT_Get_Char_Index(handle, codepoint);
+
+				if (index)
+				{
+					return select(fallback, size);
+				}
+			}
+
+			index = 0;
+
+			// Missing everywhere, so drawn as the missing glyph of the first font
+			// that loaded
+			if (primary)
+			{
+				return select(font, size);
+			}
+
+			for (uint fallback = 0; fallback < m_fonts.size(); fallback++)
+			{
+				if (face(fallback))
+				{
+					return select(fallback, size);
+				}
+			}
+
+			return nullptr;
+		}
+
+		// Whether "bounds" lies within a page
+		static bool valid(const glm::vec4 &bounds)
+		{
+			return bounds.x >= 0
+				&& bounds.y >= 0
+				&& bounds.x + bounds.z <= ATLAS_PAGE_SIZE
+				&& bounds.y + bounds.w <= ATLAS_PAGE_SIZE;
+		}
+
+		// Whether "skyline" covers the width of a page from left to right, within
+		// its height, as SkylinePacker expects
+		static bool valid(const std::vector<SkylineNode> &skyline)
+		{
+			auto x = 0;
+
+			for (const auto &node : skyline)
+			{
+				if (node.x != x || node.width <= 0 || node.width > ATLAS_PAGE_SIZE - x || node.y < 0 || node.y > ATLAS_PAGE_SIZE)
+				{
+					return false;
+				}
+
+				x += node.width;
+			}
+
+			return x == ATLAS_PAGE_SIZE;
+		}
+
+		void touch(const Glyph &glyph)
+		{
+			if (glyph.bounds.z > 0 && glyph.bounds.w > 0)
+			{
+				touch(glyph.page);
+			}
+		}
+
+		Glyph rasterize(const GlyphKey &key)
+		{
+			FT_UInt glyph_index;
+
+			const auto face = select(key.font, key.size, key.codepoint, glyph_index);
+
+			// Without a font, or if FreeType fails, the glyph is left empty, rather
+			// than taking whatever the face's glyph slot last held
+			if (!face || FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER))
+			{
+				return Glyph { glm::vec4(0, 0, 0, 0), 0, 0, 0, 0 };
+			}
+
+			const auto &bitmap = face->glyph->bitmap;
+			const auto &size = glm::ivec2(bitmap.width, bitmap.rows);
+
+			Glyph glyph
+			{
+				glm::vec4(0, 0, 0, 0),
+				0,
+
+				face->glyph->advance.x >> 6,
+				face->glyph->advance.y >> 6,
+				int(face->size->metrics.ascender >> 6) - face->glyph->bitmap_top,
+			};
+
+			if (size.x == 0 || size.y == 0)
+			{
+				return glyph;
+			}
+
+			glm::ivec2 position;
+
+			const auto index = allocate(size + GLYPH_PADDING, position);
+
+			if (index == NO_PAGE)
+			{
+				return glyph;
+			}
+
+			auto &page = m_pages[index];
+			auto pixels = page.writable();
+
+			for (auto row = 0; row < size.y; row++)
+			{
+				const auto source = bitmap.buffer + row * bitmap.pitch;
+
+				std::copy(source, source + size.x, pixels + (position.y + row) * ATLAS_PAGE_SIZE + position.x);
+			}
+
+			page.glyphs.push_back(key);
+			page.dirty = page.dirty.united(Bounds(position, position + size));
+
+			glyph.bounds = glm::vec4(position.x, position.y, size.x, size.y);
+			glyph.page = uint(index);
+
+			return glyph;
+		}
+
+		std::size_t allocate(const glm::ivec2 &size, glm::ivec2 &position)
+		{
+			if (size.x > ATLAS_PAGE_SIZE || size.y > ATLAS_PAGE_SIZE)
+			{
+				return NO_PAGE;
+			}
+
+			for (std::size_t i = 0; i < m_pages.size(); i++)
+			{
+				if (m_pages[i].packer.allocate(size, position))
+				{
+					m_pages[i].last_used = m_frame;
+
+					return i;
+				}
+			}
+
+			if ((m_pages.size() + 1) * ATLAS_PAGE_BYTES > m_budget)
+			{
+				const auto lru = std::min_element(std::begin(m_pages), std::end(m_pages), [](const AtlasPage &left, const AtlasPage &right)
+				{
+					return left.last_used < right.last_used;
+				});
+
+				// Pages used by the current frame are never recycled, in which case
+				// we go over budget rather than corrupting what is on screen
+				if (lru != std::end(m_pages) && lru->last_used < m_frame)
+				{
+					evict(*lru);
+
+					lru->packer.allocate(size, position);
+					lru->last_used = m_frame;
+
+					return std::size_t(lru - std::begin(m_pages));
+				}
+			}
+
+			m_pages.emplace_back();
+			m_pages.back().packer.allocate(size, position);
+			m_pages.back().last_used = m_frame;
+
+			return m_pages.size() - 1;
+		}
+
+		void evict(AtlasPage &page)
+		{
+			for (const auto &key : page.glyphs)
+			{
+				m_glyphs.erase(key);
+			}
+
+			page.glyphs.clear();
+			page.packer.clear();
+
+			m_generation++;
+		}
+
+		FT_Library m_library;
+
+		std::vector<Font> m_fonts;
+		std::vector<AtlasPage> m_pages;
+
+		std::unordered_map<GlyphKey, Glyph, GlyphKeyHash> m_glyphs;
+		std::unordered_map<uint64_t, uint> m_line_heights;
+
+		// Backs the pages loaded from a cache file
+		MappedFile m_mapped;
+
+		std::size_t m_budget;
+
+		uint64_t m_frame;
+		uint64_t m_generation;
+};
+
+#endif // GLYPHCACHE_H
@@ -0,0 +1,128 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <GL/glew.h>
+
+#include <array>
+
+#include "Timings.h"
+
+// Number of frames a query result is read back after it was issued, by which
+// time the GPU is done with it, so that reading it never stalls
+constexpr std::size_t GPU_TIMER_LATENCY = 4;
+
+enum class GpuPhase
+{
+	Clear,
+	Draw,
+	Present,
+	Count
+};
+
+constexpr std::size_t GPU_PHASES = std::size_t(GpuPhase::Count);
+
+// Measures how long the GPU spends on each phase of a frame, with
+// GL_TIME_ELAPSED queries. Timer queries are part of OpenGL 3.3, so this works
+// everywhere the GLRenderer does, Mesa's llvmpipe included.
+//
+// Only one query can run at a time, so phases cannot overlap.
+class GpuTimer
+{
+	public:
+		GpuTimer()
+			: m_queries()
+			, m_issued()
+			, m_frame(0)
+			, m_dropped(0)
+		{
+		}
+
+		void create()
+		{
+			glGenQueries(GLsizei(m_queries.size()), m_queries.data());
+		}
+
+		void destroy()
+		{
+			glDeleteQueries(GLsizei(m_queries.size()), m_queries.data());
+		}
+
+		void begin(GpuPhase phase)
+		{
+			const auto index = m_frame * GPU_PHASES + std::size_t(phase);
+
+			glBeginQuery(GL_TIME_ELAPSED, m_queries[index]);
+
+			m_issued[index] = true;
+		}
+
+		void end()
+		{
+			glEndQuery(GL_TIME_ELAPSED);
+		}
+
+		// Moves on to the next frame, reading back the queries that it is about
+		// to reuse. Results that are still not available by then are dropped.
+		void next_frame()
+		{
+			m_frame = (m_frame + 1) % GPU_TIMER_LATENCY;
+
+			for (std::size_t phase = 0; phase < GPU_PHASES; phase++)
+			{
+				const auto index = m_frame * GPU_PHASES + phase;
+
+				if (!m_issued[index])
+				{
+					continue;
+				}
+
+				m_issued[index] = false;
+
+				GLint available = 0;
+
+				glGetQueryObjectiv(m_queries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+
+				if (!available)
+				{
+					m_dropped++;
+
+					continue;
+				}
+
+				GLuint64 elapsed = 0;
+
+				glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &elapsed);
+
+				m_timings[phase].record(elapsed);
+			}
+		}
+
+		GpuTimings timings() const
+		{
+			GpuTimings timings;
+
+			timings.clear = m_timings[std::size_t(GpuPhase::Clear)].summary();
+			timings.draw = m_timings[std::size_t(GpuPhase::Draw)].summary();
+			timings.present = m_timings[std::size_t(GpuPhase::Present)].summary();
+
+			return timings;
+		}
+
+		// Results that were not available in time
+		uint64_t dropped() const
+		{
+			return m_dropped;
+		}
+
+	private:
+		std::array<GLuint, GPU_TIMER_LATENCY * GPU_PHASES> m_queries;
+		std::array<bool, GPU_TIMER_LATENCY * GPU_PHASES> m_issued;
+
+		std::array<RollingTimings, GPU_PHASES> m_timings;
+
+		std::size_t m_frame;
+
+		uint64_t m_dropped;
+};
+
+#endif // GPUTIMER_H
@@ -0,0 +1,156 @@
+#ifndef HITINDEX_H
+#define HITINDEX_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/common.hpp>
+
+// Width and height of every cell of the hit index, in pixels
+constexpr int HIT_CELL_SIZE = 64;
+
+// Bounds of an interactive control, in whole pixels
+struct HitEntry
+{
+	bool operator ==(const HitEntry &other) const
+	{
+		return id == other.id
+			&& min == other.min
+			&& max == other.max;
+	}
+
+	bool operator !=(const HitEntry &other) const
+	{
+		return !(*this == other);
+	}
+
+	bool contains(const glm::ivec2 &point) const
+	{
+		return point.x >= min.x
+			&& point.y >= min.y
+			&& point.x < max.x
+			&& point.y < max.y;
+	}
+
+	int id;
+
+	glm::ivec2 min;
+	glm::ivec2 max;
+};
+
+// Truncated the same way as by SDL_PointInRect, so that the index agrees with
+// testing the control directly
+inline HitEntry make_hit_entry(int id, const glm::vec2 &position, const glm::vec2 &size)
+{
+	const glm::ivec2 min((int)position.x, (int)position.y);
+
+	return { id, min, min + glm::ivec2((int)size.x, (int)size.y) };
+}
+
+// Uniform grid over the screen, telling which interactive controls are under
+// a point without testing every one of them. It is built once from the bounds
+// of the controls, and is shared by every state until those change.
+class HitIndex
+{
+	public:
+		HitIndex(std::vector<HitEntry> entries, int width, int height)
+			: m_entries(std::move(entries))
+			, m_columns((width + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE)
+			, m_rows((height + HIT_CELL_SIZE - 1) / HIT_CELL_SIZE)
+			, m_cells(m_columns * m_rows)
+		{
+			for (std::size_t i = 0; i < m_entries.size(); i++)
+			{
+				const auto &entry = m_entries[i];
+
+				if (entry.id >= (int)m_slots.size())
+				{
+					m_slots.resize(entry.id + 1, NO_ENTRY);
+				}
+
+				m_slots[entry.id] = i;
+
+				if (entry.min.x >= entry.max.x || entry.min.y >= entry.max.y)
+				{
+					continue;
+				}
+
+				// Parts outside of the screen can never be pointed at
+				const auto first = glm::max(entry.min / HIT_CELL_SIZE, glm::ivec2(0, 0));
+				const auto last = glm::min((entry.max - 1) / HIT_CELL_SIZE, glm::ivec2(m_columns - 1, m_rows - 1));
+
+				for (auto y = first.y; y <= last.y; y++)
+				{
+					for (auto x = first.x; x <= last.x; x++)
+					{
+						m_cells[y * m_columns + x].push_back(i);
+					}
+				}
+			}
+		}
+
+		const std::vector<HitEntry> &entries() const
+		{
+			return m_entries;
+		}
+
+		// What the index knows about control "id", or nullptr if nothing
+		const HitEntry *find(int id) const
+		{
+			if (id < 0 || id >= (int)m_slots.size() || m_slots[id] == NO_ENTRY)
+			{
+				return nullptr;
+			}
+
+			return &m_entries[m_slots[id]];
+		}
+
+		// Ids of the controls containing "point", in ascending order
+		std::vector<int> at(const glm::ivec2 &point) const
+		{
+			std::vector<int> ids;
+
+			if (point.x < 0 || point.y < 0)
+			{
+				return ids;
+			}
+
+			const auto cell = point / HIT_CELL_SIZE;
+
+			if (cell.x >= m_columns || cell.y >= m_rows)
+			{
+				return ids;
+			}
+
+			for (const auto i : m_cells[cell.y * m_columns + cell.x])
+			{
+				if (m_entries[i].contains(point))
+				{
+					ids.push_back(m_entries[i].id);
+				}
+			}
+
+			std::sort(std::begin(ids), std::end(ids));
+
+			return ids;
+		}
+
+	private:
+		static constexpr std::size_t NO_ENTRY = std::numeric_limits<std::size_t>::max();
+
+		std::vector<HitEntry> m_entries;
+
+		// Indices into "m_entries" by control id, as ids are levels and thus
+		// few and dense
+		std::vector<std::size_t> m_slots;
+
+		int m_columns;
+		int m_rows;
+
+		// Indices into "m_entries" of the controls overlapping each cell
+		std::vector<std::vector<std::size_t>> m_cells;
+};
+
+#endif // HITINDEX_H
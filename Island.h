@@ -0,0 +1,357 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+
+#include <limits>
+#include <memory>
+
+#include "Repack.h"
+#include "Item.h"
+#include "Trace.h"
+
+// Levels set aside for the controls of every island, which start counting
+// from the level of the island times this, and so never meet the levels of
+// the controls around them, or of other islands
+constexpr int ISLAND_LEVELS = 1 << 12;
+
+template<typename TUserState>
+class IslandSubtree;
+
+// What a pass over an island leaves behind, besides the island itself
+template<typename TUserState>
+struct IslandPass
+{
+	RootState root;
+	TUserState user;
+
+	std::shared_ptr<const IslandSubtree<TUserState>> subtree;
+};
+
+// The state of the controls of an island, as far as the layout around it is
+// concerned, which does not know their types
+template<typename TUserState>
+class IslandSubtree
+{
+	public:
+		virtual ~IslandSubtree() = default;
+
+		// Runs a pass over the controls, which leaves this subtree as it was
+		virtual IslandPass<TUserState> run(Operation operation, RootState root, TUserState user) const = 0;
+
+		// Area that changed since "previous", which is an earlier state of the same island
+		virtual Bounds damage(const IslandSubtree &previous) const = 0;
+
+		virtual bool is_affected(const RootState &root) const = 0;
+
+		// Every draw command of the controls, in the order they are drawn, and their hash
+		virtual const immutable_vector<DrawCommand> &draw_commands() const = 0;
+		virtual uint64_t hash() const = 0;
+
+		// Around every interactive control
+		virtual Bounds bounds() const = 0;
+};
+
+template<typename T>
+using IslandDrawableControlTypePredicate = std::is_base_of<DrawableControl, T>;
+
+template<typename T>
+using IslandUnfusedControlTypePredicate = std::is_base_of<UnfusedControl, T>;
+
+template<typename T>
+using IslandInteractiveControlTypePredicate = std::is_base_of<InteractiveControl, T>;
+
+// Same as Application::layout, for the controls of an island
+template<typename T, typename TStyle, int TLevel, Operation TOperation, typename TState>
+auto island_layout(TState state)
+{
+	const auto &root = T::layout(read_user_state(state));
+
+	return strip_context(root.build(Context<TOperation, TStyle, TLevel, TState> { std::move(state) }));
+}
+
+template<typename T, typename TUserState, typename TStyle, int TLevel>
+class IslandSubtreeImplementation final : public IslandSubtree<TUserState>
+{
+	public:
+		using State = decltype(island_layout<T, TStyle, TLevel, Operation::Initialize>(std::declval<std::tuple<RootState, TUserState>>()));
+
+		using DrawableSequence = make_filtered_sequence_t<IslandDrawableControlTypePredicate, State, std::make_index_sequence<std::tuple_size_v<State>>>;
+		using InteractiveSequence = make_filtered_sequence_t<IslandInteractiveControlTypePredicate, State, std::make_index_sequence<std::tuple_size_v<State>>>;
+
+		// Controls that need every other control to be updated before they are
+		// drawn, which the layout around the island needs to know about
+		static constexpr bool unfused = std::tuple_size_v<decltype(tuple_filter<IslandUnfusedControlTypePredicate>(std::declval<State>()))> > 0;
+
+		IslandSubtreeImplementation(State &&state, const IslandSubtreeImplementation *previous)
+			: m_state(std::move(state))
+			, m_hash(previous ? previous->m_hash : 0)
+			, m_bounds(interactive_bounds(m_state, InteractiveSequence()))
+		{
+			// Only the Draw pass changes draw commands, so the others keep the
+			// ones from before
+			if (previous)
+			{
+				m_draw_commands = previous->m_draw_commands;
+			}
+		}
+
+		static IslandPass<TUserState> initialize(RootState root, TUserState user)
+		{
+			auto state = island_layout<T, TStyle, TLevel, Operation::Initialize>(std::make_tuple(std::move(root), std::move(user)));
+
+			return finish(std::move(state), nullptr, true);
+		}
+
+		IslandPass<TUserState> run(Operation operation, RootState root, TUserState user) const override
+		{
+			TRACE_SCOPE("island");
+
+			auto state = m_state;
+
+			std::get<RootState>(state) = std::move(root);
+			std::get<TUserState>(state) = std::move(user);
+
+			switch (operation)
+			{
+				case Operation::Update:
+					return finish(island_layout<T, TStyle, TLevel, Operation::Update>(std::move(state)), this, false);
+
+				case Operation::Draw:
+					return finish(island_layout<T, TStyle, TLevel, Operation::Draw>(std::move(state)), this, true);
+
+				case Operation::Fused:
+					if constexpr (unfused)
+					{
+						return finish(island_layout<T, TStyle, TLevel, Operation::Draw>(island_layout<T, TStyle, TLevel, Operation::Update>(std::move(state))), this, true);
+					}
+					else
+					{
+						return finish(island_layout<T, TStyle, TLevel, Operation::Fused>(std::move(state)), this, true);
+					}
+
+				case Operation::Noop:
+					return finish(island_layout<T, TStyle, TLevel, Operation::Noop>(std::move(state)), this, true);
+
+				case Operation::Initialize:
+					break;
+			}
+
+			return finish(std::move(state), this, false);
+		}
+
+		Bounds damage(const IslandSubtree<TUserState> &previous) const override
+		{
+			const auto &state = static_cast<const IslandSubtreeImplementation &>(previous).m_state;
+
+			return compute_damage(state, m_state, DrawableSequence());
+		}
+
+		bool is_affected(const RootState &root) const override
+		{
+			return is_affected(m_state, root, InteractiveSequence());
+		}
+
+		const immutable_vector<DrawCommand> &draw_commands() const override
+		{
+			return m_draw_commands;
+		}
+
+		uint64_t hash() const override
+		{
+			return m_hash;
+		}
+
+		Bounds bounds() const override
+		{
+			return m_bounds;
+		}
+
+	private:
+		// Keeps the state, but hands the root and user states back to the
+		// layout around the island, as they are only ever borrowed
+		static IslandPass<TUserState> finish(State &&state, const IslandSubtreeImplementation *previous, bool drawn)
+		{
+			auto subtree = std::make_shared<IslandSubtreeImplementation>(std::move(state), previous);
+
+			if (drawn)
+			{
+				subtree->draw();
+			}
+
+			return
+			{
+				std::move(std::get<RootState>(subtree->m_state)),
+				std::move(std::get<TUserState>(subtree->m_state)),
+				std::move(subtree)
+			};
+		}
+
+		void draw()
+		{
+			const auto hash = compute_hash(m_state, DrawableSequence());
+
+			if (hash != m_hash || m_draw_commands.empty())
+			{
+				m_draw_commands = extract_draw_commands(tuple_filter<IslandDrawableControlTypePredicate>(m_state));
+			}
+
+			m_hash = hash;
+		}
+
+		template<std::size_t ...TIndex>
+		static bool is_affected(const State &state, const RootState &root, std::index_sequence<TIndex...>)
+		{
+			return (std::get<TIndex>(state).is_affected(root) || ...);
+		}
+
+		template<std::size_t ...TIndex>
+		static Bounds interactive_bounds(const State &state, std::index_sequence<TIndex...>)
+		{
+			Bounds bounds;
+
+			((bounds = bounds.united(Bounds(std::get<TIndex>(state).position, std::get<TIndex>(state).position + std::get<TIndex>(state).size))), ...);
+
+			return bounds;
+		}
+
+		State m_state;
+
+		uint64_t m_hash;
+		immutable_vector<DrawCommand> m_draw_commands;
+
+		Bounds m_bounds;
+};
+
+template<int TId, typename TUserState>
+struct IslandState : public DrawableControl, public InteractiveControl
+{
+	IslandState()
+		: position(0, 0)
+		, size(0, 0)
+		, hash(0)
+	{
+	}
+
+	auto with_subtree(std::shared_ptr<const IslandSubtree<TUserState>> subtree) const
+	{
+		std::decay_t<decltype(*this)> copy(*this);
+
+		const auto &bounds = subtree->bounds();
+
+		copy.position = bounds.empty() ? glm::vec2(0, 0) : bounds.min;
+		copy.size = bounds.empty() ? glm::vec2(0, 0) : bounds.max - bounds.min;
+		copy.draw_commands = subtree->draw_commands();
+		copy.hash = subtree->hash();
+		copy.subtree = std::move(subtree);
+
+		return copy;
+	}
+
+	bool is_affected(const RootState &root) const
+	{
+		return subtree->is_affected(root);
+	}
+
+	std::shared_ptr<const IslandSubtree<TUserState>> subtree;
+
+	// Around the interactive controls of the island, for the hit index
+	glm::vec2 position;
+	glm::vec2 size;
+
+	// Every draw command of the island, and the hash of the controls that drew them
+	immutable_vector<DrawCommand> draw_commands;
+	uint64_t hash;
+};
+
+// Same as IslandState, for islands with controls that opt out of fused passes
+template<int TId, typename TUserState>
+struct UnfusedIslandState : public IslandState<TId, TUserState>, public UnfusedControl
+{
+	auto with_subtree(std::shared_ptr<const IslandSubtree<TUserState>> subtree) const
+	{
+		UnfusedIslandState copy(*this);
+
+		static_cast<IslandState<TId, TUserState> &>(copy) = IslandState<TId, TUserState>::with_subtree(std::move(subtree));
+
+		return copy;
+	}
+};
+
+// Islands know which of their controls changed, and damage only those
+template<int TId, typename TUserState>
+Bounds get_island_damage(const IslandState<TId, TUserState> &previous, const IslandState<TId, TUserState> &current)
+{
+	if (previous.hash == current.hash)
+	{
+		return Bounds();
+	}
+
+	return current.subtree->damage(*previous.subtree);
+}
+
+template<int TId, typename TUserState>
+Bounds get_damage(const IslandState<TId, TUserState> &previous, const IslandState<TId, TUserState> &current)
+{
+	return get_island_damage(previous, current);
+}
+
+template<int TId, typename TUserState>
+Bounds get_damage(const UnfusedIslandState<TId, TUserState> &previous, const UnfusedIslandState<TId, TUserState> &current)
+{
+	return get_island_damage<TId, TUserState>(previous, current);
+}
+
+// Lays out "T::layout(state)" behind a boundary the types of its controls do
+// not cross. The layout around the island holds a single state for all of
+// them, and reaches them through a virtual call per pass, so the state of the
+// whole layout, and the template instantiations that go with it, grow with
+// the number of islands rather than with the number of controls in them.
+// Breaking a large screen into islands of a hundred or so controls keeps it
+// within a practical compile time and binary size.
+//
+// Every pass copies the state of the island once, and the Draw pass gathers
+// its draw commands whenever one of them changed. Damage is still tracked
+// per control. Interactive controls of an island are not in the hit index,
+// which makes them test the pointer themselves.
+template<typename T>
+struct Island : public Object
+{
+	template<typename TContext>
+	auto build(TContext &&context) const
+	{
+		constexpr auto operation = get_operation_v<TContext>;
+		constexpr auto level = get_level_v<TContext> + 1;
+
+		static_assert(level < std::numeric_limits<int>::max() / ISLAND_LEVELS, "Islands are nested too deeply");
+
+		using UserState = get_user_state_t<TContext>;
+		using Subtree = IslandSubtreeImplementation<T, UserState, get_style_t<TContext>, level * ISLAND_LEVELS>;
+		using State = std::conditional_t<Subtree::unfused, UnfusedIslandState<level, UserState>, IslandState<level, UserState>>;
+
+		auto island_context = level_up(std::forward<TContext>(context));
+
+		// Borrowed by the island for the duration of the pass
+		auto root = std::move(std::get<RootState>(island_context.state));
+		auto user = std::move(std::get<UserState>(island_context.state));
+
+		if constexpr (operation == Operation::Initialize)
+		{
+			auto pass = Subtree::initialize(std::move(root), std::move(user));
+
+			auto result = repack(repack(std::move(island_context), std::move(pass.root)), std::move(pass.user));
+
+			return context_prepend(State().with_subtree(std::move(pass.subtree)), std::move(result));
+		}
+		else
+		{
+			const auto &island = std::get<State>(island_context.state);
+
+			auto pass = island.subtree->run(operation, std::move(root), std::move(user));
+
+			const auto &next = island.with_subtree(std::move(pass.subtree));
+
+			return repack(repack(repack(std::move(island_context), std::move(pass.root)), std::move(pass.user)), next);
+		}
+	}
+};
+
+#endif // ISLAND_H
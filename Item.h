@@ -4,6 +4,7 @@
 #include "Context.h"
 #include "Properties.h"
 #include "Common.h"
+#include "Trace.h"
 
 template<typename TContext>
 auto build_children(TContext &&context)
@@ -14,25 +15,58 @@ auto build_children(TContext &&context)
 template<typename TContext, typename TChild>
 auto build_children(TContext &&context, const TChild &child)
 {
-	return child.build(context);
+	return child.build(std::forward<TContext>(context));
 }
 
 template<typename TContext, typename TChild, typename ...TChildren>
 auto build_children(TContext &&context, const TChild &child, const TChildren&... children)
 {
-	return build_children(child.build(context), children...);
+	return build_children(child.build(std::forward<TContext>(context)), children...);
 }
 
 template<typename TContext, typename TTuple, std::size_t ...TIndex>
 auto expand_children(TContext &&context, const TTuple &tuple, std::index_sequence<TIndex...>)
 {
-	return build_children(context, std::get<TIndex>(tuple)...);
+	return build_children(std::forward<TContext>(context), std::get<TIndex>(tuple)...);
 }
 
 template<typename TContext, typename TTuple>
 auto expand_children(TContext &&context, const TTuple &tuple)
 {
-	return expand_children(context, tuple, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+	return expand_children(std::forward<TContext>(context), tuple, std::make_index_sequence<std::tuple_size_v<TTuple>>());
+}
+
+// Runs the logic of a control for the operation of "context". For fused
+// passes, the control is updated and then drawn right away, each with the
+// context its logic expects, so that its own templates are expanded the same
+// way as in separate passes.
+template<template<Operation> class TLogic, typename TContext, typename TProperties>
+auto invoke_logic(TContext &&context, const TProperties &properties)
+{
+	constexpr auto operation = get_operation_v<TContext>;
+
+	if constexpr (operation == Operation::Fused)
+	{
+		TRACE_SCOPE(logic_name<TLogic>(), get_level_v<TContext>);
+
+		using Style = get_style_t<TContext>;
+
+		auto updated = TLogic<Operation::Update>::invoke(change_operation<Operation::Update>(std::forward<TContext>(context)), properties);
+
+		// The Draw logic expects the level of the control, and not the one its
+		// templates left behind
+		using DrawContext = Context<Operation::Draw, Style, get_level_v<TContext>, decltype(updated.state)>;
+
+		auto drawn = TLogic<Operation::Draw>::invoke(DrawContext { std::move(updated.state) }, properties);
+
+		return change_operation<Operation::Fused>(std::move(drawn));
+	}
+	else
+	{
+		TRACE_SCOPE(logic_name<TLogic>(), get_level_v<TContext>);
+
+		return TLogic<operation>::invoke(std::forward<TContext>(context), properties);
+	}
 }
 
 struct Object
@@ -53,13 +87,15 @@ struct Item : public Object
 	template<typename T>
 	using ChildrenTypePredicate = std::is_base_of<Object, T>;
 
+	// The state is moved from one item to the next when "context" is an rvalue,
+	// so that every item only pays for the parts of the state it changes
 	template<typename TContext>
-	auto build(const TContext &context) const
+	auto build(TContext &&context) const
 	{
 		const auto &properties = tuple_filter<PropertyTypePredicate>(m_parameters);
 		const auto &children = tuple_filter<ChildrenTypePredicate>(m_parameters);
 
-		return expand_children(TLogic<get_operation_v<TContext>>::invoke(level_up(context), properties), children);
+		return expand_children(invoke_logic<TLogic>(level_up(std::forward<TContext>(context)), properties), children);
 	}
 
 	std::tuple<TParameters...> m_parameters;
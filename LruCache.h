@@ -0,0 +1,100 @@
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include <list>
+#include <unordered_map>
+
+struct CacheStatistics
+{
+	CacheStatistics()
+		: hits(0)
+		, misses(0)
+	{
+	}
+
+	uint64_t hits;
+	uint64_t misses;
+};
+
+// Holds on to at most "capacity" values, dropping the least recently used one
+// when another one is inserted
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class LruCache
+{
+	public:
+		LruCache(std::size_t capacity)
+			: m_capacity(capacity)
+		{
+		}
+
+		// Returns the value of "key", or nullptr if there is none. The pointer is
+		// valid until the next insert or clear.
+		const TValue *find(const TKey &key)
+		{
+			const auto existing = m_index.find(key);
+
+			if (existing == std::end(m_index))
+			{
+				m_statistics.misses++;
+
+				return nullptr;
+			}
+
+			m_statistics.hits++;
+			m_entries.splice(std::begin(m_entries), m_entries, existing->second);
+
+			return &existing->second->second;
+		}
+
+		const TValue &insert(const TKey &key, const TValue &value)
+		{
+			const auto existing = m_index.find(key);
+
+			if (existing != std::end(m_index))
+			{
+				m_entries.erase(existing->second);
+				m_index.erase(existing);
+			}
+
+			if (m_entries.size() >= m_capacity)
+			{
+				m_index.erase(m_entries.back().first);
+				m_entries.pop_back();
+			}
+
+			m_entries.emplace_front(key, value);
+			m_index.emplace(key, std::begin(m_entries));
+
+			return m_entries.front().second;
+		}
+
+		void clear()
+		{
+			m_entries.clear();
+			m_index.clear();
+		}
+
+		std::size_t size() const
+		{
+			return m_entries.size();
+		}
+
+		const CacheStatistics &statistics() const
+		{
+			return m_statistics;
+		}
+
+	private:
+		typedef std::list<std::pair<TKey, TValue>> Entries;
+
+		std::size_t m_capacity;
+
+		// Most recently used first
+		Entries m_entries;
+
+		std::unordered_map<TKey, typename Entries::iterator, THash> m_index;
+
+		CacheStatistics m_statistics;
+};
+
+#endif // LRUCACHE_H
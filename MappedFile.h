@@ -0,0 +1,89 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <utility>
+
+// Read only view of a whole file, mapped into memory for as long as the object lives
+class MappedFile
+{
+	public:
+		MappedFile()
+			: m_data(nullptr)
+			, m_size(0)
+		{
+		}
+
+		MappedFile(const std::string &path)
+			: MappedFile()
+		{
+			const auto descriptor = open(path.c_str(), O_RDONLY);
+
+			if (descriptor < 0)
+			{
+				return;
+			}
+
+			struct stat status;
+
+			if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+			{
+				const auto data = mmap(nullptr, std::size_t(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+				if (data != MAP_FAILED)
+				{
+					m_data = static_cast<const uint8_t *>(data);
+					m_size = std::size_t(status.st_size);
+				}
+			}
+
+			// The mapping stays valid after the descriptor is closed
+			close(descriptor);
+		}
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator =(const MappedFile &) = delete;
+
+		MappedFile(MappedFile &&other)
+			: m_data(std::exchange(other.m_data, nullptr))
+			, m_size(std::exchange(other.m_size, 0))
+		{
+		}
+
+		MappedFile &operator =(MappedFile &&other)
+		{
+			std::swap(m_data, other.m_data);
+			std::swap(m_size, other.m_size);
+
+			return *this;
+		}
+
+		~MappedFile()
+		{
+			if (m_data)
+			{
+				munmap(const_cast<uint8_t *>(m_data), m_size);
+			}
+		}
+
+		const uint8_t *data() const
+		{
+			return m_data;
+		}
+
+		std::size_t size() const
+		{
+			return m_size;
+		}
+
+	private:
+		const uint8_t *m_data;
+		std::size_t m_size;
+};
+
+#endif // MAPPEDFILE_H
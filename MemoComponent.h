@@ -0,0 +1,136 @@
+#ifndef MEMOCOMPONENT_H
+#define MEMOCOMPONENT_H
+
+#include <optional>
+
+#include "Repack.h"
+#include "Item.h"
+
+// What a memoized component built its subtree from the last time it went
+// through the Update and Draw passes
+template<int TId, typename TInputs>
+struct MemoState : public IsolatedControl
+{
+	MemoState()
+		: glyph_generation(0)
+	{
+	}
+
+	STATE_PROPERTY(std::optional<TInputs>, updated)
+	STATE_PROPERTY(std::optional<TInputs>, drawn)
+	STATE_PROPERTY(uint64_t, glyph_generation)
+};
+
+// A component that only reads the part of the user state picked by
+// "T::select(state)", and lays itself out from that alone with
+// "T::layout(selection, parameters)". As long as neither the selection nor the
+// parameters change, the Update and Draw passes leave its subtree untouched,
+// keeping the control states and draw commands from the last time around.
+//
+// The subtree is not updated for events that do not change its inputs either,
+// so it is meant for content that is static as far as the user is concerned,
+// and not for controls with a visual state of their own, like buttons.
+// Both the selection and the parameters need to be equality comparable.
+template<typename T, typename ...TParameters>
+struct MemoComponent : public Object
+{
+	MemoComponent(const TParameters &...parameters)
+		: m_parameters(parameters...)
+	{
+	}
+
+	template<typename TContext>
+	auto build(TContext &&context) const
+	{
+		constexpr auto operation = get_operation_v<TContext>;
+
+		// Taken by value, as the user state moves along with the context
+		const auto selection = T::select(read_user_state(context));
+
+		using Inputs = std::tuple<std::decay_t<decltype(selection)>, std::tuple<TParameters...>>;
+		using State = MemoState<get_level_v<TContext> + 1, Inputs>;
+
+		auto memo_context = level_up(std::forward<TContext>(context));
+
+		if constexpr (operation == Operation::Initialize)
+		{
+			const auto &item = T::layout(selection, m_parameters);
+
+			return item.build(context_prepend(State(), std::move(memo_context)));
+		}
+		else
+		{
+			// What the subtree would have left behind, had it been built
+			using Result = std::decay_t<decltype(T::layout(selection, m_parameters).build(std::move(memo_context)))>;
+
+			const auto &root = read_root_state(memo_context);
+			const auto &inputs = Inputs(selection, m_parameters);
+			const auto generation = root.glyphs ? root.glyphs->generation() : 0;
+
+			const auto memo = std::get<State>(memo_context.state);
+
+			if constexpr (operation == Operation::Update)
+			{
+				if (memo.updated == inputs)
+				{
+					return Result { std::move(memo_context.state) };
+				}
+			}
+
+			// Evicted glyphs might be referred to by the draw commands
+			if constexpr (operation == Operation::Draw)
+			{
+				if (memo.drawn == inputs && memo.glyph_generation == generation)
+				{
+					return Result { std::move(memo_context.state) };
+				}
+			}
+
+			if constexpr (operation == Operation::Fused)
+			{
+				if (memo.updated == inputs && memo.drawn == inputs && memo.glyph_generation == generation)
+				{
+					return Result { std::move(memo_context.state) };
+				}
+			}
+
+			const auto &item = T::layout(selection, m_parameters);
+
+			auto result = item.build(std::move(memo_context));
+
+			if constexpr (operation == Operation::Update)
+			{
+				return repack(std::move(result), memo
+					.with_updated(inputs)
+					.with_drawn(std::nullopt)
+					);
+			}
+
+			if constexpr (operation == Operation::Draw)
+			{
+				return repack(std::move(result), memo
+					.with_drawn(inputs)
+					.with_glyph_generation(generation)
+					);
+			}
+
+			if constexpr (operation == Operation::Fused)
+			{
+				return repack(std::move(result), memo
+					.with_updated(inputs)
+					.with_drawn(inputs)
+					.with_glyph_generation(generation)
+					);
+			}
+
+			// Skipped subtrees lose their draw commands
+			return repack(std::move(result), memo
+				.with_drawn(std::nullopt)
+				);
+		}
+	}
+
+	std::tuple<TParameters...> m_parameters;
+};
+
+#endif // MEMOCOMPONENT_H
@@ -21,9 +21,9 @@ template<>
 struct MouseAreaLogic<Operation::Initialize>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
-		return context_prepend(MouseAreaState<get_level_v<TContext>, get_user_state_t<TContext>>(), context);
+		return context_prepend(MouseAreaState<get_level_v<TContext>, get_user_state_t<TContext>>(), std::move(context));
 	}
 };
 
@@ -31,11 +31,11 @@ template<>
 struct MouseAreaLogic<Operation::Update>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &properties)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &properties)
 	{
 		const auto &rectangle = std::get<MouseAreaState<get_level_v<TContext>, get_user_state_t<TContext>>>(context.state);
 
-		return repack(context,
+		return repack(std::move(context),
 			apply_properties(properties, rectangle)
 		);
 	}
@@ -45,7 +45,7 @@ template<>
 struct MouseAreaLogic<Operation::Draw>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		return context;
 	}
@@ -0,0 +1,162 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <array>
+#include <optional>
+
+#include "Item.h"
+#include "ThreadPool.h"
+
+// Context that "TChildren" leave behind when built one after the other from "TContext"
+template<typename TContext, typename ...TChildren>
+using built_context_t = std::decay_t<decltype(build_children(std::declval<TContext>(), std::declval<const TChildren &>()...))>;
+
+// Groups its children without adding a level, and builds them on the layout
+// thread pool instead of one after the other, wherever it is safe to do so.
+//
+// Every control state is keyed by its level, and each child owns the levels
+// between the one it starts from and the one it leaves behind. As long as
+// only isolated controls are found in those levels, children cannot see
+// each other, so each of them is built from its own copy of the state, and
+// their control states are collected from those copies afterwards. This is
+// the same state as building them in order would have given. Children that
+// are not isolated, and the Initialize pass, which adds to the state, are
+// built in order, on the calling thread.
+//
+// Every child copies the whole state, so children are best kept large.
+template<typename ...TChildren>
+struct Parallel : public Object
+{
+	Parallel(const TChildren &...children)
+		: m_children(children...)
+	{
+	}
+
+	template<typename TContext>
+	auto build(TContext &&context) const
+	{
+		using Input = std::decay_t<TContext>;
+
+		constexpr auto operation = get_operation_v<TContext>;
+		constexpr auto parallel = sizeof...(TChildren) > 1
+			&& (operation == Operation::Update || operation == Operation::Draw || operation == Operation::Fused)
+			&& is_isolated<Input>();
+
+		if constexpr (parallel)
+		{
+			return build_parallel(std::forward<TContext>(context), std::index_sequence_for<TChildren...>());
+		}
+		else
+		{
+			return expand_children(std::forward<TContext>(context), m_children);
+		}
+	}
+
+	// Context that the first children leave behind, which the next one starts from
+	template<typename TContext, std::size_t ...TIndex>
+	static auto prefix_context(std::index_sequence<TIndex...>) -> built_context_t<TContext, std::tuple_element_t<TIndex, std::tuple<TChildren...>>...>;
+
+	template<typename TContext, std::size_t TCount>
+	using prefix_context_t = decltype(prefix_context<TContext>(std::make_index_sequence<TCount>()));
+
+	// Levels that separate the children, where child "i" owns the control
+	// states above level "i", up to and including level "i + 1"
+	template<typename TContext, std::size_t ...TIndex>
+	static constexpr auto boundaries(std::index_sequence<TIndex...>)
+	{
+		return std::array<int, sizeof...(TIndex)> { get_level_v<prefix_context_t<TContext, TIndex>>... };
+	}
+
+	template<typename TContext>
+	static constexpr auto boundaries()
+	{
+		return boundaries<TContext>(std::make_index_sequence<sizeof...(TChildren) + 1>());
+	}
+
+	// Child owning the control state with "id", or the first one for anything
+	// that is not owned by a child, as every child leaves that as it was
+	template<typename TContext>
+	static constexpr std::size_t owner(int id)
+	{
+		constexpr auto levels = boundaries<TContext>();
+
+		for (std::size_t i = 0; i < sizeof...(TChildren); i++)
+		{
+			if (id > levels[i] && id <= levels[i + 1])
+			{
+				return i;
+			}
+		}
+
+		return 0;
+	}
+
+	// Whether every control state owned by a child is that of an isolated control
+	template<typename TContext, typename TState, std::size_t ...TElement>
+	static constexpr bool is_isolated(std::index_sequence<TElement...>)
+	{
+		constexpr auto levels = boundaries<TContext>();
+
+		return ((get_control_id_v<std::tuple_element_t<TElement, TState>> <= levels.front()
+			|| get_control_id_v<std::tuple_element_t<TElement, TState>> > levels.back()
+			|| std::is_base_of_v<IsolatedControl, std::tuple_element_t<TElement, TState>>) && ...);
+	}
+
+	template<typename TContext>
+	static constexpr bool is_isolated()
+	{
+		using State = decltype(TContext::state);
+
+		return is_isolated<TContext, State>(std::make_index_sequence<std::tuple_size_v<State>>());
+	}
+
+	template<typename TContext, std::size_t ...TIndex>
+	auto build_parallel(TContext &&context, std::index_sequence<TIndex...>) const
+	{
+		using Input = std::decay_t<TContext>;
+		using State = decltype(Input::state);
+		using Result = prefix_context_t<Input, sizeof...(TChildren)>;
+
+		std::array<std::optional<State>, sizeof...(TChildren)> results;
+
+		// Every child but the first gets a copy, before the first one moves
+		// the state along
+		std::array<std::optional<State>, sizeof...(TChildren)> inputs;
+
+		((TIndex > 0 ? (void)inputs[TIndex].emplace(context.state) : (void)0), ...);
+
+		inputs[0].emplace(std::move(context.state));
+
+		const std::array<std::function<void()>, sizeof...(TChildren)> tasks =
+		{
+			[&]
+			{
+				using Start = prefix_context_t<Input, TIndex>;
+
+				results[TIndex].emplace(strip_context(std::get<TIndex>(m_children).build(Start { std::move(*inputs[TIndex]) })));
+			}...
+		};
+
+		ThreadPool::layout().run(tasks.data(), tasks.size());
+
+		return merge<Input, Result>(results, std::make_index_sequence<std::tuple_size_v<State>>());
+	}
+
+	template<typename TContext, typename TResult, typename TResults, std::size_t ...TElement>
+	static TResult merge(TResults &results, std::index_sequence<TElement...>)
+	{
+		using State = decltype(TContext::state);
+
+		return TResult
+		{
+			State
+			{
+				std::move(std::get<TElement>(*results[owner<TContext>(get_control_id_v<std::tuple_element_t<TElement, State>>)]))...
+			}
+		};
+	}
+
+	std::tuple<TChildren...> m_children;
+};
+
+#endif // PARALLEL_H
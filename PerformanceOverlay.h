@@ -0,0 +1,262 @@
+#ifndef PERFORMANCEOVERLAY_H
+#define PERFORMANCEOVERLAY_H
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <sstream>
+
+#include "Allocations.h"
+#include "Common.h"
+#include "Item.h"
+
+// Number of painted frames shown in the chart of the overlay
+constexpr std::size_t OVERLAY_HISTORY = 60;
+
+// Painted frames between updates of the figures of the overlay, which would
+// be too jittery to read otherwise, and would fill the text layout cache
+constexpr uint64_t OVERLAY_TEXT_INTERVAL = 15;
+
+// Frame time that keeps up with a 60 Hz display, in microseconds, which is
+// drawn half way up the chart
+constexpr uint32_t OVERLAY_FRAME_BUDGET = 16667;
+
+constexpr uint OVERLAY_BACKGROUND_COLOR = 0xc0202020;
+constexpr uint OVERLAY_TEXT_COLOR = 0xffe0e0e0;
+constexpr uint OVERLAY_BUDGET_COLOR = 0xff00c0ff;
+constexpr uint OVERLAY_FAST_COLOR = 0xff40c040;
+constexpr uint OVERLAY_SLOW_COLOR = 0xff4040e0;
+
+constexpr float OVERLAY_PADDING = 4;
+
+// Frame times in microseconds, oldest first
+using OverlayHistory = std::array<uint32_t, OVERLAY_HISTORY>;
+
+template<int TId, typename TUserState>
+struct PerformanceOverlayState : public DrawableControl, public OverlayControl
+{
+	PerformanceOverlayState()
+		: history()
+		, text_painted(0)
+		, drawn(0)
+		, glyph_generation(0)
+	{
+	}
+
+	STATE_PROPERTY(glm::vec2, size)
+	STATE_PROPERTY(glm::vec2, position)
+
+	// As of the last painted frame
+	STATE_PROPERTY(FrameStatistics, statistics)
+	STATE_PROPERTY(OverlayHistory, history)
+
+	// Figures shown, one line each, and the painted frame they are from
+	STATE_PROPERTY(std::string, text)
+	STATE_PROPERTY(uint64_t, text_painted)
+
+	// Painted frame that the draw commands show
+	STATE_PROPERTY(uint64_t, drawn)
+	STATE_PROPERTY(uint64_t, glyph_generation)
+
+	DRAW_COMMANDS_PROPERTY
+};
+
+// Figures of "statistics", one line each
+inline std::string format_overlay_text(const FrameStatistics &statistics)
+{
+	const auto laid_out = statistics.skipped + statistics.unchanged + statistics.painted;
+	const auto skipped = laid_out ? 100 * (statistics.skipped + statistics.unchanged) / laid_out : 0;
+
+	std::ostringstream stream;
+
+	stream << std::fixed << std::setprecision(2)
+		<< "frame " << statistics.frame_time / 1e6 << " ms  layout " << statistics.layout_time / 1e6 << " ms\n"
+		<< statistics.instances << " instances  " << std::setprecision(1) << statistics.uploaded_bytes / 1024.0 << " KB uploaded\n"
+		<< skipped << "% skipped  ";
+
+	// Nothing is counted unless the application asked for it
+	if (allocation_count())
+	{
+		stream << statistics.allocations << " allocations";
+	}
+	else
+	{
+		stream << "allocations not counted";
+	}
+
+	return stream.str();
+}
+
+template<Operation TOperation>
+struct PerformanceOverlayLogic
+{
+	template<typename TContext, typename ...TProperties>
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
+	{
+		const auto &overlay = read_control_state<PerformanceOverlayState>(context);
+
+		return repack(std::move(context), overlay
+			.with_draw_commands({})
+			);
+	}
+};
+
+template<>
+struct PerformanceOverlayLogic<Operation::Initialize>
+{
+	template<typename TContext, typename ...TProperties>
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
+	{
+		return context_prepend(PerformanceOverlayState<get_level_v<TContext>, get_user_state_t<TContext>>(), std::move(context));
+	}
+};
+
+template<>
+struct PerformanceOverlayLogic<Operation::Update>
+{
+	template<typename TContext, typename ...TProperties>
+	static auto invoke(TContext context, const std::tuple<TProperties...> &properties)
+	{
+		const auto &overlay = apply_properties(properties, read_control_state<PerformanceOverlayState>(context));
+		const auto &statistics = read_root_state(context).statistics;
+
+		// Statistics only change in ways worth showing once a frame is painted
+		if (statistics.painted == overlay.statistics.painted)
+		{
+			return repack(std::move(context), overlay);
+		}
+
+		auto history = overlay.history;
+
+		std::rotate(std::begin(history), std::begin(history) + 1, std::end(history));
+
+		history.back() = uint32_t(std::min<uint64_t>(statistics.frame_time / 1000, std::numeric_limits<uint32_t>::max()));
+
+		const auto refresh = overlay.text.empty() || statistics.painted - overlay.text_painted >= OVERLAY_TEXT_INTERVAL;
+
+		return repack(std::move(context), overlay
+			.with_statistics(statistics)
+			.with_history(history)
+			.with_text(refresh ? format_overlay_text(statistics) : overlay.text)
+			.with_text_painted(refresh ? statistics.painted : overlay.text_painted)
+			);
+	}
+};
+
+template<>
+struct PerformanceOverlayLogic<Operation::Draw>
+{
+	template<typename TContext, typename ...TProperties>
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
+	{
+		const auto &overlay = read_control_state<PerformanceOverlayState>(context);
+		const auto &root = read_root_state(context);
+
+		const auto &background = DrawCommand()
+			.with_position(overlay.position)
+			.with_size(overlay.size)
+			.with_color(OVERLAY_BACKGROUND_COLOR);
+
+		// The background goes first, and tells whether the overlay has moved
+		if (!overlay.draw_commands.empty()
+			&& *std::begin(overlay.draw_commands) == background
+			&& overlay.drawn == overlay.statistics.painted
+			&& overlay.glyph_generation == root.glyphs->generation())
+		{
+			return context;
+		}
+
+		std::vector<DrawCommand> commands { background };
+
+		std::vector<std::string> lines;
+		std::istringstream text(overlay.text);
+
+		for (std::string line; std::getline(text, line);)
+		{
+			lines.push_back(line);
+		}
+
+		const auto &inner = overlay.position + OVERLAY_PADDING;
+		const auto width = overlay.size.x - 2 * OVERLAY_PADDING;
+		const auto height = overlay.size.y - 3 * OVERLAY_PADDING - float(lines.size() * root.font_height);
+
+		// One bar per frame, with the frame budget half way up
+		const auto bar = width / OVERLAY_HISTORY;
+		const auto bottom = inner.y + height;
+
+		for (std::size_t i = 0; i < OVERLAY_HISTORY; i++)
+		{
+			const auto time = overlay.history[i];
+
+			if (!time)
+			{
+				continue;
+			}
+
+			const auto bar_height = std::min(float(time) / (2 * OVERLAY_FRAME_BUDGET), 1.0f) * height;
+
+			commands.push_back(DrawCommand()
+				.with_position(glm::vec2(inner.x + i * bar, bottom - bar_height))
+				.with_size(glm::vec2(std::max(bar - 1, 1.0f), bar_height))
+				.with_color(time > OVERLAY_FRAME_BUDGET ? OVERLAY_SLOW_COLOR : OVERLAY_FAST_COLOR)
+				);
+		}
+
+		commands.push_back(DrawCommand()
+			.with_position(glm::vec2(inner.x, bottom - height / 2))
+			.with_size(glm::vec2(width, 1))
+			.with_color(OVERLAY_BUDGET_COLOR)
+			);
+
+		for (std::size_t i = 0; i < lines.size(); i++)
+		{
+			const TextLayoutKey key
+			{
+				lines[i],
+
+				DEFAULT_FONT,
+				DEFAULT_FONT_SIZE,
+
+				AlignLeft | AlignTop,
+				glm::vec2(width, root.font_height),
+			};
+
+			const auto &origin = glm::vec2(inner.x, bottom + OVERLAY_PADDING + i * root.font_height);
+
+			for (const auto &command : root.layouts->layout(key, *root.glyphs, root.font_height))
+			{
+				commands.push_back(command
+					.with_position(glm::vec2(command.position) + origin)
+					.with_color(OVERLAY_TEXT_COLOR)
+					);
+			}
+		}
+
+		return repack(std::move(context), overlay
+			.with_draw_commands(commands)
+			.with_drawn(overlay.statistics.painted)
+			.with_glyph_generation(root.glyphs->generation())
+			);
+	}
+};
+
+// Shows how the application is doing: a chart of the time taken by the last
+// painted frames, against the budget of a 60 Hz display, and below it the
+// time of the last frame and of its layout passes, the instances drawn, the
+// bytes uploaded, how many frames were skipped (because no control reacted
+// to their events, or because they hashed the same as the one on screen)
+// and the allocations made by the last frame.
+//
+// The overlay is left out of the hash, so it never makes a frame be painted
+// on its own, and only ever shows frames that were painted anyway. It is best
+// placed last, to be drawn over everything else.
+template<typename ...TParameters>
+struct PerformanceOverlay : public Item<PerformanceOverlayLogic, TParameters...>
+{
+	PerformanceOverlay(const TParameters &...parameters)
+		: Item<PerformanceOverlayLogic, TParameters...>(parameters...)
+	{
+	}
+};
+
+#endif // PERFORMANCEOVERLAY_H
@@ -0,0 +1,398 @@
+#ifndef PERSISTENTMAP_H
+#define PERSISTENTMAP_H
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+// A hash map where every update returns a new map, sharing everything but the
+// path to the updated entry with the original. Entries are kept in a hash array
+// mapped trie, consuming 5 bits of the hash per level, with entries and nodes
+// kept apart in each node so that equal maps always end up with the same trie.
+// Keys whose hashes are equal are kept in a collision node at the bottom.
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class PersistentMap
+{
+	static constexpr unsigned BITS = 5;
+	static constexpr unsigned HASH_BITS = sizeof(std::size_t) * 8;
+
+	typedef std::pair<TKey, TValue> Entry;
+
+	struct Node
+	{
+		Node()
+			: data_map(0)
+			, node_map(0)
+		{
+		}
+
+		// Which of the 32 slots hold an entry, and which hold a node. Collision
+		// nodes have neither, and keep their entries in no particular order.
+		uint32_t data_map;
+		uint32_t node_map;
+
+		std::vector<Entry> entries;
+		std::vector<std::shared_ptr<const Node>> children;
+	};
+
+	typedef std::shared_ptr<const Node> NodePointer;
+
+	public:
+		PersistentMap()
+			: m_size(0)
+			, m_root(empty_node())
+		{
+		}
+
+		std::size_t size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return m_size == 0;
+		}
+
+		// Returns the value of "key", or nullptr if there is none. The pointer is
+		// valid for as long as any map sharing the entry is around.
+		const TValue *find(const TKey &key) const
+		{
+			const auto hash = THash()(key);
+
+			const Node *node = m_root.get();
+
+			for (unsigned shift = 0; shift < HASH_BITS; shift += BITS)
+			{
+				const auto bit = slot(hash, shift);
+
+				if (node->data_map & bit)
+				{
+					const auto &entry = node->entries[index(node->data_map, bit)];
+
+					return entry.first == key
+						? &entry.second
+						: nullptr;
+				}
+
+				if (!(node->node_map & bit))
+				{
+					return nullptr;
+				}
+
+				node = node->children[index(node->node_map, bit)].get();
+			}
+
+			const auto existing = std::find_if(std::begin(node->entries), std::end(node->entries), [&](const Entry &entry)
+			{
+				return entry.first == key;
+			});
+
+			return existing == std::end(node->entries)
+				? nullptr
+				: &existing->second;
+		}
+
+		bool contains(const TKey &key) const
+		{
+			return find(key) != nullptr;
+		}
+
+		// Returns a copy where "key" maps to "value"
+		PersistentMap with(const TKey &key, const TValue &value) const
+		{
+			auto added = false;
+
+			PersistentMap copy(*this);
+			copy.m_root = insert(m_root, Entry(key, value), THash()(key), 0, added);
+			copy.m_size += added;
+
+			return copy;
+		}
+
+		// Returns a copy without "key", which is this map if there was no "key"
+		PersistentMap without(const TKey &key) const
+		{
+			auto removed = false;
+
+			PersistentMap copy(*this);
+			copy.m_root = remove(m_root, key, THash()(key), 0, removed);
+			copy.m_size -= removed;
+
+			return copy;
+		}
+
+		// Calls "function" with the key and value of every entry, in no particular order
+		template<typename TFunction>
+		void for_each(const TFunction &function) const
+		{
+			for_each(m_root, function);
+		}
+
+		// Maps that share their contents compare equal without looking at the
+		// entries, and so do any subtrees they share
+		bool operator ==(const PersistentMap &other) const
+		{
+			if (m_size != other.m_size)
+			{
+				return false;
+			}
+
+			return equal(m_root, other.m_root, 0);
+		}
+
+		bool operator !=(const PersistentMap &other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		static const NodePointer &empty_node()
+		{
+			static const NodePointer empty = std::make_shared<Node>();
+
+			return empty;
+		}
+
+		static uint32_t slot(std::size_t hash, unsigned shift)
+		{
+			return uint32_t(1) << ((hash >> shift) & 31);
+		}
+
+		// Where the entry or node in "bit" is stored, given the bits in use
+		static std::size_t index(uint32_t map, uint32_t bit)
+		{
+			return __builtin_popcount(map & (bit - 1));
+		}
+
+		// A node holding the two entries, with as many levels in between as it
+		// takes to tell their hashes apart
+		static NodePointer merge(const Entry &first, std::size_t first_hash, const Entry &second, std::size_t second_hash, unsigned shift)
+		{
+			auto node = std::make_shared<Node>();
+
+			if (shift >= HASH_BITS)
+			{
+				node->entries = { first, second };
+
+				return node;
+			}
+
+			const auto first_bit = slot(first_hash, shift);
+			const auto second_bit = slot(second_hash, shift);
+
+			if (first_bit == second_bit)
+			{
+				node->node_map = first_bit;
+				node->children.push_back(merge(first, first_hash, second, second_hash, shift + BITS));
+
+				return node;
+			}
+
+			node->data_map = first_bit | second_bit;
+			node->entries = first_bit < second_bit
+				? std::vector<Entry> { first, second }
+				: std::vector<Entry> { second, first };
+
+			return node;
+		}
+
+		static NodePointer insert(const NodePointer &node, const Entry &entry, std::size_t hash, unsigned shift, bool &added)
+		{
+			auto copy = std::make_shared<Node>(*node);
+
+			if (shift >= HASH_BITS)
+			{
+				const auto existing = std::find_if(std::begin(copy->entries), std::end(copy->entries), [&](const Entry &candidate)
+				{
+					return candidate.first == entry.first;
+				});
+
+				if (existing == std::end(copy->entries))
+				{
+					copy->entries.push_back(entry);
+					added = true;
+				}
+				else
+				{
+					existing->second = entry.second;
+				}
+
+				return copy;
+			}
+
+			const auto bit = slot(hash, shift);
+
+			if (node->data_map & bit)
+			{
+				const auto position = index(node->data_map, bit);
+				const auto &existing = node->entries[position];
+
+				if (existing.first == entry.first)
+				{
+					copy->entries[position].second = entry.second;
+
+					return copy;
+				}
+
+				// Two different keys in the same slot, so both move down a level
+				const auto &child = merge(existing, THash()(existing.first), entry, hash, shift + BITS);
+
+				copy->entries.erase(std::begin(copy->entries) + position);
+				copy->data_map &= ~bit;
+				copy->node_map |= bit;
+				copy->children.insert(std::begin(copy->children) + index(copy->node_map, bit), child);
+
+				added = true;
+
+				return copy;
+			}
+
+			if (node->node_map & bit)
+			{
+				const auto position = index(node->node_map, bit);
+
+				copy->children[position] = insert(node->children[position], entry, hash, shift + BITS, added);
+
+				return copy;
+			}
+
+			copy->data_map |= bit;
+			copy->entries.insert(std::begin(copy->entries) + index(copy->data_map, bit), entry);
+
+			added = true;
+
+			return copy;
+		}
+
+		static NodePointer remove(const NodePointer &node, const TKey &key, std::size_t hash, unsigned shift, bool &removed)
+		{
+			if (shift >= HASH_BITS)
+			{
+				const auto existing = std::find_if(std::begin(node->entries), std::end(node->entries), [&](const Entry &entry)
+				{
+					return entry.first == key;
+				});
+
+				if (existing == std::end(node->entries))
+				{
+					return node;
+				}
+
+				auto copy = std::make_shared<Node>(*node);
+				copy->entries.erase(std::begin(copy->entries) + (existing - std::begin(node->entries)));
+
+				removed = true;
+
+				return copy;
+			}
+
+			const auto bit = slot(hash, shift);
+
+			if (node->data_map & bit)
+			{
+				const auto position = index(node->data_map, bit);
+
+				if (!(node->entries[position].first == key))
+				{
+					return node;
+				}
+
+				auto copy = std::make_shared<Node>(*node);
+				copy->entries.erase(std::begin(copy->entries) + position);
+				copy->data_map &= ~bit;
+
+				removed = true;
+
+				return copy;
+			}
+
+			if (!(node->node_map & bit))
+			{
+				return node;
+			}
+
+			const auto position = index(node->node_map, bit);
+			const auto &child = remove(node->children[position], key, hash, shift + BITS, removed);
+
+			if (child == node->children[position])
+			{
+				return node;
+			}
+
+			auto copy = std::make_shared<Node>(*node);
+
+			// A node left with a single entry is folded back into its parent, so
+			// that the trie looks the same as if the key was never inserted
+			if (child->children.empty() && child->entries.size() == 1)
+			{
+				copy->children.erase(std::begin(copy->children) + position);
+				copy->node_map &= ~bit;
+				copy->data_map |= bit;
+				copy->entries.insert(std::begin(copy->entries) + index(copy->data_map, bit), child->entries.front());
+
+				return copy;
+			}
+
+			copy->children[position] = child;
+
+			return copy;
+		}
+
+		template<typename TFunction>
+		static void for_each(const NodePointer &node, const TFunction &function)
+		{
+			for (const auto &entry : node->entries)
+			{
+				function(entry.first, entry.second);
+			}
+
+			for (const auto &child : node->children)
+			{
+				for_each(child, function);
+			}
+		}
+
+		static bool equal(const NodePointer &left, const NodePointer &right, unsigned shift)
+		{
+			if (left == right)
+			{
+				return true;
+			}
+
+			if (shift >= HASH_BITS)
+			{
+				return left->entries.size() == right->entries.size()
+					&& std::is_permutation(std::begin(left->entries), std::end(left->entries), std::begin(right->entries));
+			}
+
+			if (left->data_map != right->data_map || left->node_map != right->node_map)
+			{
+				return false;
+			}
+
+			if (left->entries != right->entries)
+			{
+				return false;
+			}
+
+			for (std::size_t i = 0; i < left->children.size(); i++)
+			{
+				if (!equal(left->children[i], right->children[i], shift + BITS))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		std::size_t m_size;
+
+		NodePointer m_root;
+};
+
+#endif // PERSISTENTMAP_H
@@ -0,0 +1,341 @@
+#ifndef PERSISTENTVECTOR_H
+#define PERSISTENTVECTOR_H
+
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <initializer_list>
+
+// A vector where every update returns a new vector, sharing everything but the
+// path to the updated element with the original. Elements are kept in a 32 way
+// trie, with the last (up to) 32 elements in a separate tail, which makes
+// appending cheap as well. Copying it is as cheap as copying two pointers.
+template<typename T>
+class PersistentVector
+{
+	static constexpr unsigned BITS = 5;
+	static constexpr std::size_t WIDTH = 1 << BITS;
+	static constexpr std::size_t MASK = WIDTH - 1;
+
+	// Branches only have children, and leaves (as well as the tail) only have values
+	struct Node
+	{
+		std::vector<std::shared_ptr<const Node>> children;
+		std::vector<T> values;
+	};
+
+	typedef std::shared_ptr<const Node> NodePointer;
+
+	public:
+		class const_iterator
+		{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef T value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const T *pointer;
+				typedef const T &reference;
+
+				const_iterator(const PersistentVector *vector, std::size_t index)
+					: m_vector(vector)
+					, m_index(index)
+					, m_leaf(index < vector->size() ? &vector->leaf_for(index) : nullptr)
+				{
+				}
+
+				reference operator *() const
+				{
+					return (*m_leaf)[m_index & MASK];
+				}
+
+				pointer operator ->() const
+				{
+					return &**this;
+				}
+
+				const_iterator &operator ++()
+				{
+					m_index++;
+
+					// Only look up the leaf when crossing into the next one
+					if ((m_index & MASK) == 0 && m_index < m_vector->size())
+					{
+						m_leaf = &m_vector->leaf_for(m_index);
+					}
+
+					return *this;
+				}
+
+				const_iterator operator ++(int)
+				{
+					const_iterator copy(*this);
+					++*this;
+
+					return copy;
+				}
+
+				bool operator ==(const const_iterator &other) const
+				{
+					return m_index == other.m_index;
+				}
+
+				bool operator !=(const const_iterator &other) const
+				{
+					return m_index != other.m_index;
+				}
+
+			private:
+				const PersistentVector *m_vector;
+				std::size_t m_index;
+				const std::vector<T> *m_leaf;
+		};
+
+		PersistentVector()
+			: m_size(0)
+			, m_shift(BITS)
+			, m_root(empty_node())
+			, m_tail(empty_node())
+		{
+		}
+
+		PersistentVector(std::initializer_list<T> values)
+			: PersistentVector()
+		{
+			for (const auto &value : values)
+			{
+				*this = with_appended(value);
+			}
+		}
+
+		std::size_t size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return m_size == 0;
+		}
+
+		const T &operator [](std::size_t index) const
+		{
+			return leaf_for(index)[index & MASK];
+		}
+
+		const T &back() const
+		{
+			return m_tail->values.back();
+		}
+
+		const_iterator begin() const
+		{
+			return const_iterator(this, 0);
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator(this, m_size);
+		}
+
+		// Returns a copy where element "index" is "value"
+		PersistentVector with(std::size_t index, const T &value) const
+		{
+			PersistentVector copy(*this);
+
+			if (index >= tail_offset())
+			{
+				auto tail = std::make_shared<Node>(*m_tail);
+				tail->values[index & MASK] = value;
+
+				copy.m_tail = tail;
+			}
+			else
+			{
+				copy.m_root = assign(m_shift, m_root, index, value);
+			}
+
+			return copy;
+		}
+
+		// Returns a copy with "value" added at the end
+		PersistentVector with_appended(const T &value) const
+		{
+			PersistentVector copy(*this);
+			copy.m_size++;
+
+			if (m_size - tail_offset() < WIDTH)
+			{
+				auto tail = std::make_shared<Node>(*m_tail);
+				tail->values.push_back(value);
+
+				copy.m_tail = tail;
+
+				return copy;
+			}
+
+			// The tail is full, so it becomes a leaf of the trie, which gets
+			// another level if there is no room left for it
+			if ((m_size >> BITS) > (std::size_t(1) << m_shift))
+			{
+				auto root = std::make_shared<Node>();
+				root->children.push_back(m_root);
+				root->children.push_back(path_to(m_shift, m_tail));
+
+				copy.m_root = root;
+				copy.m_shift += BITS;
+			}
+			else
+			{
+				copy.m_root = push_tail(m_shift, m_root, m_tail);
+			}
+
+			auto tail = std::make_shared<Node>();
+			tail->values.push_back(value);
+
+			copy.m_tail = tail;
+
+			return copy;
+		}
+
+		// Vectors that share their contents compare equal without looking at the
+		// elements, and so do any subtrees they share
+		bool operator ==(const PersistentVector &other) const
+		{
+			if (m_size != other.m_size)
+			{
+				return false;
+			}
+
+			return equal(m_shift, m_root, other.m_root)
+				&& (m_tail == other.m_tail || m_tail->values == other.m_tail->values);
+		}
+
+		bool operator !=(const PersistentVector &other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		static const NodePointer &empty_node()
+		{
+			static const NodePointer empty = std::make_shared<Node>();
+
+			return empty;
+		}
+
+		// Index of the first element in the tail
+		std::size_t tail_offset() const
+		{
+			if (m_size < WIDTH)
+			{
+				return 0;
+			}
+
+			return ((m_size - 1) >> BITS) << BITS;
+		}
+
+		const std::vector<T> &leaf_for(std::size_t index) const
+		{
+			if (index >= tail_offset())
+			{
+				return m_tail->values;
+			}
+
+			const Node *node = m_root.get();
+
+			for (auto level = m_shift; level > 0; level -= BITS)
+			{
+				node = node->children[(index >> level) & MASK].get();
+			}
+
+			return node->values;
+		}
+
+		static NodePointer assign(unsigned level, const NodePointer &node, std::size_t index, const T &value)
+		{
+			auto copy = std::make_shared<Node>(*node);
+
+			if (level == 0)
+			{
+				copy->values[index & MASK] = value;
+			}
+			else
+			{
+				const auto child = (index >> level) & MASK;
+
+				copy->children[child] = assign(level - BITS, node->children[child], index, value);
+			}
+
+			return copy;
+		}
+
+		// Wraps "leaf" in branches until it reaches "level"
+		static NodePointer path_to(unsigned level, const NodePointer &leaf)
+		{
+			if (level == 0)
+			{
+				return leaf;
+			}
+
+			auto branch = std::make_shared<Node>();
+			branch->children.push_back(path_to(level - BITS, leaf));
+
+			return branch;
+		}
+
+		NodePointer push_tail(unsigned level, const NodePointer &node, const NodePointer &leaf) const
+		{
+			auto copy = std::make_shared<Node>(*node);
+
+			const auto child = ((m_size - 1) >> level) & MASK;
+
+			const auto &inserted = level == BITS
+				? leaf
+				: child < node->children.size()
+					? push_tail(level - BITS, node->children[child], leaf)
+					: path_to(level - BITS, leaf);
+
+			if (child < copy->children.size())
+			{
+				copy->children[child] = inserted;
+			}
+			else
+			{
+				copy->children.push_back(inserted);
+			}
+
+			return copy;
+		}
+
+		// Both tries hold the same number of elements, so they have the same shape
+		static bool equal(unsigned level, const NodePointer &left, const NodePointer &right)
+		{
+			if (left == right)
+			{
+				return true;
+			}
+
+			if (level == 0)
+			{
+				return left->values == right->values;
+			}
+
+			for (std::size_t i = 0; i < left->children.size(); i++)
+			{
+				if (!equal(level - BITS, left->children[i], right->children[i]))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		std::size_t m_size;
+		unsigned m_shift;
+
+		NodePointer m_root;
+		NodePointer m_tail;
+};
+
+#endif // PERSISTENTVECTOR_H
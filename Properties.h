@@ -24,6 +24,11 @@ struct name##_Property\
 		{\
 			return state.with_##name (value);\
 		}\
+\
+		bool operator ==(const Setter &other) const\
+		{\
+			return value == other.value;\
+		}\
 \
 		TValue value;\
 	};\
@@ -3,8 +3,6 @@
 
 #include <SDL.h>
 
-#include <glm/gtx/matrix_transform_2d.hpp>
-
 #include <tuple>
 #include <vector>
 
@@ -12,23 +10,23 @@
 #include "Item.h"
 
 template<int TId, typename TUserState>
-struct RectangleState : public DrawableControl
+struct RectangleState : public DrawableControl, public IsolatedControl
 {
 	STATE_PROPERTY(glm::vec2, size)
 	STATE_PROPERTY(glm::vec2, position)
 	STATE_PROPERTY(uint, color)
-	STATE_PROPERTY(std::vector<DrawCommand>, draw_commands)
+	DRAW_COMMANDS_PROPERTY
 };
 
 template<Operation TOperation>
 struct RectangleLogic
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &rectangle = read_control_state<RectangleState>(context);
 
-		return repack(context,
+		return repack(std::move(context),
 			rectangle.with_draw_commands({})
 		);
 	}
@@ -38,9 +36,9 @@ template<>
 struct RectangleLogic<Operation::Initialize>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
-		return context_prepend(RectangleState<get_level_v<TContext>, get_user_state_t<TContext>>(), context);
+		return context_prepend(RectangleState<get_level_v<TContext>, get_user_state_t<TContext>>(), std::move(context));
 	}
 };
 
@@ -48,11 +46,11 @@ template<>
 struct RectangleLogic<Operation::Update>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &properties)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &properties)
 	{
 		const auto &rectangle = read_control_state<RectangleState>(context);
 
-		return repack(context,
+		return repack(std::move(context),
 			apply_properties(properties, rectangle)
 		);
 	}
@@ -62,15 +60,23 @@ template<>
 struct RectangleLogic<Operation::Draw>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &rectangle = read_control_state<RectangleState>(context);
 
 		const auto &draw_command = DrawCommand()
-			.with_matrix(glm::scale(glm::translate(glm::mat3(1.0f), rectangle.position), rectangle.size))
+			.with_position(rectangle.position)
+			.with_size(rectangle.size)
 			.with_color(rectangle.color);
 
-		return repack(context
+		// Rectangles that did not change keep sharing their draw commands with
+		// earlier states, rather than allocating new ones every frame
+		if (rectangle.draw_commands.size() == 1 && *std::begin(rectangle.draw_commands) == draw_command)
+		{
+			return context;
+		}
+
+		return repack(std::move(context)
 			, rectangle.with_draw_commands({ draw_command })
 		);
 	}
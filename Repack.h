@@ -12,7 +12,7 @@ auto tuple_append(const TTuple &tuple, const TAddition &addition)
 template<typename TTuple, typename TAddition>
 auto tuple_prepend(const TAddition &addition, TTuple &&tuple)
 {
-	return std::tuple_cat(std::make_tuple(addition), tuple);
+	return std::tuple_cat(std::make_tuple(addition), std::forward<TTuple>(tuple));
 }
 
 template<Operation TOperation, typename TStyle, int TLevel, typename TState, typename TAddition>
@@ -21,55 +21,82 @@ auto context_prepend(const TAddition &addition, const Context<TOperation, TStyle
 	return { tuple_prepend(addition, context.state) };
 }
 
+template<Operation TOperation, typename TStyle, int TLevel, typename TState, typename TAddition>
+auto context_prepend(const TAddition &addition, Context<TOperation, TStyle, TLevel, TState> &&context) -> Context<TOperation, TStyle, TLevel, decltype(tuple_prepend(addition, std::move(context.state)))>
+{
+	return { tuple_prepend(addition, std::move(context.state)) };
+}
+
 template<int TIndex, typename TTuple>
 using Element = typename std::tuple_element<TIndex, TTuple>::type;
 
-template<int TIndex, typename TTuple, typename TElement>
-struct Repack
+// Element "TIndex" of the repacked tuple, which is "element" if it is of the same type
+template<std::size_t TIndex, typename TTuple, typename TElement>
+const auto &select_element(const TTuple &tuple, const TElement &element)
 {
-	static auto value(const TTuple &tuple, const TElement &element)
+	if constexpr (std::is_same_v<Element<TIndex, TTuple>, TElement>)
 	{
-		return tuple_append(Repack<TIndex - 1, TTuple, TElement>::value(tuple, element), std::get<TIndex>(tuple));
+		return element;
 	}
-};
-
-template<int TIndex, typename TTuple>
-struct Repack<TIndex, TTuple, Element<TIndex, TTuple>>
-{
-	static auto value(const TTuple &tuple, const Element<TIndex, TTuple> &element)
+	else
 	{
-		return tuple_append(Repack<TIndex - 1, TTuple, Element<TIndex, TTuple>>::value(tuple, element), element);
+		return std::get<TIndex>(tuple);
 	}
-};
+}
 
-template<typename TTuple, typename TElement>
-struct Repack<0, TTuple, TElement>
+template<std::size_t TIndex, typename TTuple, typename TElement>
+void replace_element(TTuple &tuple, TElement &&element)
 {
-	static auto value(const TTuple &tuple, const TElement &)
+	if constexpr (std::is_same_v<Element<TIndex, TTuple>, std::decay_t<TElement>>)
 	{
-		return std::make_tuple(std::get<0>(tuple));
+		std::get<TIndex>(tuple) = std::forward<TElement>(element);
 	}
-};
+}
 
-template<typename TTuple>
-struct Repack<0, TTuple, Element<0, TTuple>>
+template<typename TTuple, typename TElement, std::size_t ...TIndex>
+TTuple repack(const TTuple &tuple, const TElement &element, std::index_sequence<TIndex...>)
 {
-	static auto value(const TTuple &, const Element<0, TTuple> &element)
-	{
-		return std::make_tuple(element);
-	}
-};
+	return TTuple { select_element<TIndex>(tuple, element)... };
+}
 
+// Every type occurs at most once in the state, as control states are keyed
+// by their level, so at most one element is replaced here
+template<typename TTuple, typename TElement, std::size_t ...TIndex>
+void replace(TTuple &tuple, TElement &&element, std::index_sequence<TIndex...>)
+{
+	(replace_element<TIndex>(tuple, std::forward<TElement>(element)), ...);
+}
+
+// Returns a copy of "context" where "element" has taken the place of the
+// element of the same type
 template<Operation TOperation, typename TStyle, int TLevel, typename TTuple, typename TElement>
 Context<TOperation, TStyle, TLevel, TTuple> repack(const Context<TOperation, TStyle, TLevel, TTuple> &context, const TElement &element)
 {
-	return { Repack<std::tuple_size<TTuple>::value - 1, TTuple, TElement>::value(context.state, element) };
+	return { repack(context.state, element, std::make_index_sequence<std::tuple_size_v<TTuple>>()) };
+}
+
+// Same as above, but for a context that is not used anymore, in which case
+// the element is replaced in place without copying the rest of the state
+template<Operation TOperation, typename TStyle, int TLevel, typename TTuple, typename TElement>
+Context<TOperation, TStyle, TLevel, TTuple> repack(Context<TOperation, TStyle, TLevel, TTuple> &&context, TElement &&element)
+{
+	replace(context.state, std::forward<TElement>(element), std::make_index_sequence<std::tuple_size_v<TTuple>>());
+
+	return std::move(context);
+}
+
+template<typename ...TElements, typename TElement>
+std::tuple<TElements...> repack(const std::tuple<TElements...> &state, const TElement &element)
+{
+	return repack(state, element, std::index_sequence_for<TElements...>());
 }
 
-template<typename TTuple, typename TElement>
-TTuple repack(const TTuple &state, const TElement &element)
+template<typename ...TElements, typename TElement>
+std::tuple<TElements...> repack(std::tuple<TElements...> &&state, TElement &&element)
 {
-	return Repack<std::tuple_size<TTuple>::value - 1, TTuple, TElement>::value(state, element);
+	replace(state, std::forward<TElement>(element), std::index_sequence_for<TElements...>());
+
+	return std::move(state);
 }
 
 #endif // REPACK_H
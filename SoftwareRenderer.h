@@ -0,0 +1,294 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include "Common.h"
+#include "Timings.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Matches glClearColor(0, 0, 0, 1), with pixels stored as R, G, B, A bytes
+constexpr uint32_t CLEAR_COLOR = 0xff000000;
+
+// Rounded division by 255 of a value no larger than 255 * 255
+inline uint32_t divide_255(uint32_t value)
+{
+	value += 128;
+
+	return (value + (value >> 8)) >> 8;
+}
+
+// Blends "color" over "count" pixels with GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+// where "alpha" holds the alpha of the source for every pixel
+void blend_span(uint32_t *target, std::size_t count, uint32_t color, const uint8_t *alpha)
+{
+	std::size_t i = 0;
+
+#ifdef __SSE2__
+	const auto zero = _mm_setzero_si128();
+	const auto max = _mm_set1_epi16(255);
+	const auto half = _mm_set1_epi16(128);
+
+	const short r = short(color & 0xff);
+	const short g = short((color >> 8) & 0xff);
+	const short b = short((color >> 16) & 0xff);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const auto destination = _mm_loadu_si128(reinterpret_cast<const __m128i *>(target + i));
+
+		const short a0 = alpha[i + 0];
+		const short a1 = alpha[i + 1];
+		const short a2 = alpha[i + 2];
+		const short a3 = alpha[i + 3];
+
+		const __m128i sources[] =
+		{
+			_mm_set_epi16(a1, b, g, r, a0, b, g, r),
+			_mm_set_epi16(a3, b, g, r, a2, b, g, r),
+		};
+
+		const __m128i alphas[] =
+		{
+			_mm_set_epi16(a1, a1, a1, a1, a0, a0, a0, a0),
+			_mm_set_epi16(a3, a3, a3, a3, a2, a2, a2, a2),
+		};
+
+		const __m128i destinations[] =
+		{
+			_mm_unpacklo_epi8(destination, zero),
+			_mm_unpackhi_epi8(destination, zero),
+		};
+
+		__m128i results[2];
+
+		for (int j = 0; j < 2; j++)
+		{
+			const auto weighted = _mm_add_epi16(
+				_mm_mullo_epi16(sources[j], alphas[j]),
+				_mm_mullo_epi16(destinations[j], _mm_sub_epi16(max, alphas[j]))
+				);
+
+			const auto rounded = _mm_add_epi16(weighted, half);
+
+			results[j] = _mm_srli_epi16(_mm_add_epi16(rounded, _mm_srli_epi16(rounded, 8)), 8);
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(target + i), _mm_packus_epi16(results[0], results[1]));
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		const uint32_t a = alpha[i];
+		const uint32_t source = (color & 0x00ffffff) | (a << 24);
+
+		uint32_t result = 0;
+
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			const auto s = (source >> shift) & 0xff;
+			const auto d = (target[i] >> shift) & 0xff;
+
+			result |= divide_255(s * a + d * (255 - a)) << shift;
+		}
+
+		target[i] = result;
+	}
+}
+
+// Renders draw commands into an RGBA framebuffer in memory, without any window
+// or GPU, following what shader.vert and shader.frag do closely enough for the
+// output to be compared with that of the GLRenderer
+class SoftwareRenderer
+{
+	public:
+		SoftwareRenderer()
+			: m_uploading(0)
+			, m_uploaded(0)
+		{
+		}
+
+		void create()
+		{
+			m_framebuffer.assign(SCREEN_WIDTH * SCREEN_HEIGHT, CLEAR_COLOR);
+		}
+
+		void destroy()
+		{
+			m_pages.clear();
+			m_framebuffer.clear();
+		}
+
+		// There is no context to hand over to another thread
+		void acquire()
+		{
+		}
+
+		void release()
+		{
+		}
+
+		// Copies the parts of the atlas pages that have changed since last time
+		template<typename TGlyphs>
+		void upload_glyphs(TGlyphs &glyphs)
+		{
+			m_pages.resize(glyphs.page_count(), std::vector<uint8_t>(ATLAS_PAGE_BYTES));
+
+			glyphs.flush([this](uint page, const uint8_t *pixels, const Bounds &dirty)
+			{
+				const auto x0 = int(dirty.min.x);
+				const auto x1 = int(dirty.max.x);
+
+				m_uploading += std::size_t(dirty.area());
+
+				for (auto y = int(dirty.min.y); y < int(dirty.max.y); y++)
+				{
+					const auto offset = y * ATLAS_PAGE_SIZE;
+
+					std::copy(pixels + offset + x0, pixels + offset + x1, m_pages[page].data() + offset + x0);
+				}
+			});
+		}
+
+		template<typename TDrawables>
+		void draw(const TDrawables &drawables, const Bounds &damage)
+		{
+			if (damage.empty())
+			{
+				return;
+			}
+
+			m_commands.resize(count_draw_commands(drawables));
+
+			const auto begin = m_commands.data();
+			const auto end = write_draw_commands(drawables, begin, damage);
+
+			m_uploading += std::size_t(end - begin) * sizeof(DrawCommand);
+
+			const auto x0 = int(damage.min.x);
+			const auto x1 = int(damage.max.x);
+
+			for (auto y = int(damage.min.y); y < int(damage.max.y); y++)
+			{
+				std::fill(row(y) + x0, row(y) + x1, CLEAR_COLOR);
+			}
+
+			for (auto command = begin; command != end; command++)
+			{
+				rasterize(*command, damage);
+			}
+		}
+
+		void present()
+		{
+			m_uploaded = m_uploading;
+			m_uploading = 0;
+		}
+
+		// There is no GPU involved
+		GpuTimings gpu_timings() const
+		{
+			return GpuTimings();
+		}
+
+		// Bytes of glyphs and draw commands copied for the last frame, as the
+		// GLRenderer would have uploaded them
+		std::size_t uploaded_bytes() const
+		{
+			return m_uploaded;
+		}
+
+		// Rows are stored from the top of the screen to the bottom, with every
+		// pixel laid out as R, G, B and A bytes
+		const std::vector<uint32_t> &framebuffer() const
+		{
+			return m_framebuffer;
+		}
+
+	private:
+		uint32_t *row(int y)
+		{
+			return m_framebuffer.data() + y * SCREEN_WIDTH;
+		}
+
+		uint8_t sample(const std::vector<uint8_t> &page, const glm::vec4 &uv, float u, float v) const
+		{
+			// GL_CLAMP_TO_EDGE, as set up for the font texture by the GLRenderer
+			const auto clamp = [](float value)
+			{
+				return std::clamp(int(std::floor(value * ATLAS_PAGE_SIZE)), 0, ATLAS_PAGE_SIZE - 1);
+			};
+
+			return page[std::size_t(clamp(uv.y + uv.w * v) * ATLAS_PAGE_SIZE + clamp(uv.x + uv.z * u))];
+		}
+
+		void rasterize(const DrawCommand &command, const Bounds &clip)
+		{
+			// Quads are axis aligned and snapped to whole pixels, so the pixels
+			// covered are exactly those inside the bounds
+			const auto &bounds = get_bounds(command).intersected(clip);
+
+			if (bounds.empty())
+			{
+				return;
+			}
+
+			const auto x0 = int(bounds.min.x);
+			const auto x1 = int(bounds.max.x);
+			const auto y0 = int(bounds.min.y);
+			const auto y1 = int(bounds.max.y);
+
+			const auto textured = command.textured();
+			const auto color = command.color;
+			const auto alpha = uint8_t(color >> 24);
+
+			const auto count = std::size_t(x1 - x0);
+
+			if (!textured && alpha == 0xff)
+			{
+				for (auto y = y0; y < y1; y++)
+				{
+					std::fill(row(y) + x0, row(y) + x1, color);
+				}
+
+				return;
+			}
+
+			m_coverage.assign(count, alpha);
+
+			const auto &uv = glm::vec4(command.uv) / 65535.0f;
+			const auto &size = glm::vec2(command.size);
+
+			for (auto y = y0; y < y1; y++)
+			{
+				if (textured)
+				{
+					const auto &page = m_pages[command.page];
+					const auto v = (y + 0.5f - command.position.y) / size.y;
+
+					for (std::size_t i = 0; i < count; i++)
+					{
+						const auto u = (x0 + i + 0.5f - command.position.x) / size.x;
+
+						m_coverage[i] = uint8_t(divide_255(sample(page, uv, u, v) * alpha));
+					}
+				}
+
+				blend_span(row(y) + x0, count, color, m_coverage.data());
+			}
+		}
+
+		std::vector<std::vector<uint8_t>> m_pages;
+		std::vector<uint32_t> m_framebuffer;
+
+		// Scratch buffers, kept around to avoid allocating for every frame
+		std::vector<DrawCommand> m_commands;
+		std::vector<uint8_t> m_coverage;
+
+		std::size_t m_uploading;
+		std::size_t m_uploaded;
+};
+
+#endif // SOFTWARERENDERER_H
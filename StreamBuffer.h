@@ -0,0 +1,156 @@
+#ifndef STREAMBUFFER_H
+#define STREAMBUFFER_H
+
+#include <GL/glew.h>
+
+#include <array>
+
+#include "DrawCommand.h"
+
+#define offset(t, d) reinterpret_cast<void *>(offsetof(t, d))
+
+// Number of instance buffers cycled through, allowing the CPU to fill one
+// while the GPU is still consuming the previous ones
+constexpr std::size_t FRAMES_IN_FLIGHT = 3;
+
+// How long (in nanoseconds) to wait for the GPU to release a segment before giving up
+constexpr GLuint64 FENCE_TIMEOUT = 1000000000;
+
+struct StreamSegment
+{
+	GLuint vao;
+	GLuint buffer;
+	GLsync fence;
+
+	std::size_t capacity;
+};
+
+class StreamBuffer
+{
+	public:
+		StreamBuffer()
+			: m_segments()
+			, m_current(0)
+		{
+		}
+
+		void create(GLuint vbo, GLuint ibo)
+		{
+			for (auto &segment : m_segments)
+			{
+				glGenVertexArrays(1, &segment.vao);
+				glGenBuffers(1, &segment.buffer);
+
+				glBindVertexArray(segment.vao);
+
+				glBindBuffer(GL_ARRAY_BUFFER, vbo);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+
+				glBindBuffer(GL_ARRAY_BUFFER, segment.buffer);
+
+				for (GLuint attribute = 1; attribute <= 5; attribute++)
+				{
+					glEnableVertexAttribArray(attribute);
+					glVertexAttribDivisor(attribute, 1);
+				}
+
+				glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DrawCommand), offset(DrawCommand, color));
+				glVertexAttribPointer(2, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(DrawCommand), offset(DrawCommand, uv));
+				glVertexAttribPointer(3, 2, GL_SHORT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, position));
+				glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, size));
+				glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(DrawCommand), offset(DrawCommand, page));
+			}
+
+			glBindVertexArray(0);
+		}
+
+		void destroy()
+		{
+			for (auto &segment : m_segments)
+			{
+				if (segment.fence)
+				{
+					glDeleteSync(segment.fence);
+				}
+
+				glDeleteBuffers(1, &segment.buffer);
+				glDeleteVertexArrays(1, &segment.vao);
+
+				segment = StreamSegment();
+			}
+		}
+
+		// Waits until the next segment is no longer in use by the GPU, makes sure
+		// it can hold "count" commands and lets "writer" fill the mapped storage,
+		// returning the end of what it wrote. The segment's vertex array is left
+		// bound, ready for drawing the returned number of commands.
+		template<typename TWriter>
+		std::size_t upload(std::size_t count, const TWriter &writer)
+		{
+			auto &segment = m_segments[m_current];
+
+			// Whether the GPU is known to be done with this segment
+			auto released = true;
+
+			if (segment.fence)
+			{
+				const auto result = glClientWaitSync(segment.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+
+				released = result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+
+				glDeleteSync(segment.fence);
+
+				segment.fence = nullptr;
+			}
+
+			glBindVertexArray(segment.vao);
+			glBindBuffer(GL_ARRAY_BUFFER, segment.buffer);
+
+			const auto size = count * sizeof(DrawCommand);
+
+			if (size > segment.capacity)
+			{
+				segment.capacity = std::max(size, segment.capacity * 2);
+
+				glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(segment.capacity), nullptr, GL_STREAM_DRAW);
+			}
+
+			if (size == 0)
+			{
+				return 0;
+			}
+
+			// Once the fence above has signaled, the GPU is done with this segment,
+			// so there is no need for the driver to synchronize (or copy) anything.
+			// If the wait timed out or failed, the driver has to do it instead.
+			const GLbitfield access = released
+				? GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+				: GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+
+			auto target = glMapBufferRange(GL_ARRAY_BUFFER, 0, GLsizeiptr(size), access);
+
+			const auto begin = static_cast<DrawCommand *>(target);
+			const auto end = writer(begin);
+
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+
+			return std::size_t(end - begin);
+		}
+
+		// Marks the end of the GPU commands reading from the current segment and
+		// moves on to the next one
+		void fence()
+		{
+			m_segments[m_current].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			m_current = (m_current + 1) % FRAMES_IN_FLIGHT;
+		}
+
+	private:
+		std::array<StreamSegment, FRAMES_IN_FLIGHT> m_segments;
+		std::size_t m_current;
+};
+
+#endif // STREAMBUFFER_H
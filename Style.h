@@ -35,12 +35,11 @@ struct skip_template
 	}
 
 	template<typename TContext>
-	auto build(const TContext &context) const
+	auto build(TContext &&context) const
 	{
-		const auto &noop_context = change_operation<Operation::Noop>(context);
-		const auto &result = subject.build(noop_context);
-
-		return change_operation<get_operation_v<TContext>>(result);
+		return change_operation<get_operation_v<TContext>>(
+			subject.build(change_operation<Operation::Noop>(std::forward<TContext>(context)))
+			);
 	}
 
 	TTemplate subject;
@@ -59,15 +58,15 @@ auto operator|(const TTemplate &t, const skip_template_decorator &)
 constexpr skip_template_decorator skip;
 
 template<typename TContext, typename TTemplates>
-auto expand_templates(const TContext &context, const TTemplates &t)
+auto expand_templates(TContext &&context, const TTemplates &t)
 {
-	return t.build(context);
+	return t.build(std::forward<TContext>(context));
 }
 
 template<typename TContext, typename TTemplate, typename ...TTemplates>
-auto expand_templates(const TContext &context, const TTemplate &t, const TTemplates &... templates)
+auto expand_templates(TContext &&context, const TTemplate &t, const TTemplates &... templates)
 {
-	return expand_templates(expand_templates(context, templates...), t);
+	return expand_templates(expand_templates(std::forward<TContext>(context), templates...), t);
 }
 
 #endif // STYLE_H
@@ -4,18 +4,36 @@
 #include "Item.h"
 
 template<int TId, typename TUserState>
-struct TextBoxState
+struct TextBoxState : public UnfusedControl, public InteractiveControl
 {
 	STATE_PROPERTY(glm::vec2, size)
 	STATE_PROPERTY(glm::vec2, position)
 	STATE_PROPERTY(VisualState, state)
+
+	bool is_affected(const RootState &root) const
+	{
+		if (!is_pointer_event(root.event))
+		{
+			return false;
+		}
+
+		const auto pointed = root.is_pointed(make_hit_entry(TId, position, size));
+
+		// Focused
+		if (pointed && root.event.type == SDL_MOUSEBUTTONDOWN)
+		{
+			return true;
+		}
+
+		return state != (pointed ? VisualState::Hover : VisualState::Normal);
+	}
 };
 
 template<Operation TOperation>
 struct TextBoxLogic
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		return context;
 	}
@@ -25,12 +43,12 @@ template<>
 struct TextBoxLogic<Operation::Initialize>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &text_box = TextBoxState<get_level_v<TContext>, get_user_state_t<TContext>>();
-		const auto &new_context = context_prepend(text_box, context);
+		auto new_context = context_prepend(text_box, std::move(context));
 
-		return expand_templates(new_context
+		return expand_templates(std::move(new_context)
 			, get_style_t<TContext>::TextBoxStyle::Normal::layout(text_box)
 			, get_style_t<TContext>::TextBoxStyle::Hover::layout(text_box)
 			, get_style_t<TContext>::TextBoxStyle::Focused::layout(text_box)
@@ -42,12 +60,12 @@ template<>
 struct TextBoxLogic<Operation::Update>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &properties)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &properties)
 	{
-		const auto &new_context =
+		auto new_context =
 			handle_focus(
 				calculate_state(
-					repack(context,
+					repack(std::move(context),
 						apply_properties(properties,
 							read_control_state<TextBoxState>(context)
 						)
@@ -57,7 +75,7 @@ struct TextBoxLogic<Operation::Update>
 
 		const auto &text_box = read_control_state<TextBoxState>(new_context);
 
-		return expand_templates(new_context
+		return expand_templates(std::move(new_context)
 			, get_style_t<TContext>::TextBoxStyle::Normal::layout(text_box)
 			, get_style_t<TContext>::TextBoxStyle::Hover::layout(text_box)
 			, get_style_t<TContext>::TextBoxStyle::Focused::layout(text_box)
@@ -65,42 +83,47 @@ struct TextBoxLogic<Operation::Update>
 	}
 
 	template<typename TContext>
-	static TContext handle_focus(const TContext &context)
+	static TContext handle_focus(TContext context)
 	{
 		const auto &root = read_root_state(context);
 		const auto &text_box = read_control_state<TextBoxState>(context);
 
-		const SDL_Rect rect = { (int)text_box.position.x, (int)text_box.position.y, (int)text_box.size.x, (int)text_box.size.y };
-		const SDL_Point point = { root.event.motion.x, root.event.motion.y };
-
-		if (!SDL_PointInRect(&point, &rect))
+		if (!root.is_pointed(make_hit_entry(get_level_v<TContext>, text_box.position, text_box.size)))
 		{
 			return context;
 		}
 
 		if (root.event.button.type == SDL_MOUSEBUTTONDOWN)
 		{
-			return repack(context, root.with_focused(get_level_v<TContext>));
+			return repack(std::move(context), root.with_focused(get_level_v<TContext>));
 		}
 
 		return context;
 	}
 
 	template<typename TContext>
-	static TContext calculate_state(const TContext &context)
+	static TContext calculate_state(TContext context)
 	{
 		const auto &root = read_root_state(context);
 		const auto &text_box = read_control_state<TextBoxState>(context);
 
-		const SDL_Rect rect = { (int)text_box.position.x, (int)text_box.position.y, (int)text_box.size.x, (int)text_box.size.y };
-		const SDL_Point point = { root.event.motion.x, root.event.motion.y };
+		// Such as the ticks of timers, which do not move the pointer
+		if (!is_pointer_event(root.event))
+		{
+			return context;
+		}
 
-		if (!SDL_PointInRect(&point, &rect))
+		if (!root.is_pointed(make_hit_entry(get_level_v<TContext>, text_box.position, text_box.size)))
 		{
-			return repack(context, text_box.with_state(VisualState::Normal));
+			if (text_box.state == VisualState::Normal)
+			{
+				return context;
+			}
+
+			return repack(std::move(context), text_box.with_state(VisualState::Normal));
 		}
 
-		return repack(context, text_box.with_state(VisualState::Hover));
+		return repack(std::move(context), text_box.with_state(VisualState::Hover));
 	}
 };
 
@@ -108,14 +131,14 @@ template<>
 struct TextBoxLogic<Operation::Draw>
 {
 	template<typename TContext, typename ...TProperties>
-	static auto invoke(const TContext &context, const std::tuple<TProperties...> &)
+	static auto invoke(TContext context, const std::tuple<TProperties...> &)
 	{
 		const auto &root = read_root_state(context);
 		const auto &text_box = read_control_state<TextBoxState>(context);
 
 		if (root.focused == get_level_v<TContext>)
 		{
-			return expand_templates(context
+			return expand_templates(std::move(context)
 				, get_style_t<TContext>::TextBoxStyle::Normal::layout(text_box) | skip
 				, get_style_t<TContext>::TextBoxStyle::Hover::layout(text_box) | skip
 				, get_style_t<TContext>::TextBoxStyle::Focused::layout(text_box)
@@ -124,14 +147,14 @@ struct TextBoxLogic<Operation::Draw>
 
 		if (text_box.state == VisualState::Hover)
 		{
-			return expand_templates(context
+			return expand_templates(std::move(context)
 				, get_style_t<TContext>::TextBoxStyle::Normal::layout(text_box) | skip
 				, get_style_t<TContext>::TextBoxStyle::Hover::layout(text_box)
 				, get_style_t<TContext>::TextBoxStyle::Focused::layout(text_box) | skip
 				);
 		}
 
-		return expand_templates(context
+		return expand_templates(std::move(context)
 			, get_style_t<TContext>::TextBoxStyle::Normal::layout(text_box)
 			, get_style_t<TContext>::TextBoxStyle::Hover::layout(text_box) | skip
 			, get_style_t<TContext>::TextBoxStyle::Focused::layout(text_box) | skip
@@ -0,0 +1,261 @@
+#ifndef TEXTLAYOUT_H
+#define TEXTLAYOUT_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "GlyphCache.h"
+#include "LruCache.h"
+#include "Utf8.h"
+
+enum Alignment
+{
+	// Horizontal
+	AlignLeft = 0x0001,
+	AlignRight = 0x0002,
+	AlignHCenter = 0x0004,
+	AlignJustify = 0x0008,
+
+	// Vertical
+	AlignTop = 0x0020,
+	AlignBottom = 0x0040,
+	AlignVCenter =0x0080,
+	AlignBaseline = 0x0100,
+};
+
+// How many laid out texts, and how many runs of text, that are kept around
+constexpr std::size_t DEFAULT_TEXT_LAYOUT_CAPACITY = 1024;
+constexpr std::size_t DEFAULT_TEXT_RUN_CAPACITY = 4096;
+
+struct TextRunKey
+{
+	std::string text;
+
+	uint font;
+	uint size;
+
+	bool operator ==(const TextRunKey &other) const
+	{
+		return text == other.text
+			&& font == other.font
+			&& size == other.size;
+	}
+};
+
+struct TextRunKeyHash
+{
+	std::size_t operator ()(const TextRunKey &key) const
+	{
+		return std::size_t(combine_hash(combine_hash(std::hash<std::string>()(key.text), key.font), key.size));
+	}
+};
+
+// Glyphs of a run of text, positioned relative to where the run starts
+struct TextRun
+{
+	std::vector<DrawCommand> commands;
+
+	long width;
+};
+
+struct TextLayoutKey
+{
+	std::string text;
+
+	uint font;
+	uint size;
+
+	int alignment;
+
+	glm::vec2 box;
+
+	bool operator ==(const TextLayoutKey &other) const
+	{
+		return text == other.text
+			&& font == other.font
+			&& size == other.size
+			&& alignment == other.alignment
+			&& box == other.box;
+	}
+};
+
+struct TextLayoutKeyHash
+{
+	std::size_t operator ()(const TextLayoutKey &key) const
+	{
+		const auto &text = combine_hash(std::hash<std::string>()(key.text), key.font);
+		const auto &box = combine_hash(std::hash<float>()(key.box.x), std::hash<float>()(key.box.y));
+
+		return std::size_t(combine_hash(combine_hash(combine_hash(text, key.size), uint64_t(key.alignment)), box));
+	}
+};
+
+struct TextLayoutStatistics
+{
+	CacheStatistics layouts;
+	CacheStatistics runs;
+};
+
+// Splits "text" after every space, so that words can be shared between texts
+std::vector<std::string> split_runs(const std::string &text)
+{
+	std::vector<std::string> runs;
+
+	for (std::size_t start = 0; start < text.size();)
+	{
+		const auto space = text.find(' ', start);
+		const auto end = space == std::string::npos ? text.size() : space + 1;
+
+		runs.push_back(text.substr(start, end - start));
+
+		start = end;
+	}
+
+	return runs;
+}
+
+int get_horizontal_offset(const TextLayoutKey &key, long width)
+{
+	if (key.alignment & AlignLeft)
+	{
+		return 0;
+	}
+
+	if (key.alignment & AlignHCenter)
+	{
+		return int((key.box.x - width) / 2);
+	}
+
+	return int(key.box.x - width);
+}
+
+int get_vertical_offset(const TextLayoutKey &key, uint font_height)
+{
+	if (key.alignment & AlignTop)
+	{
+		return 0;
+	}
+
+	if (key.alignment & AlignVCenter)
+	{
+		return int((key.box.y - font_height) / 2);
+	}
+
+	return int(key.box.y - font_height);
+}
+
+// Lays out text into draw commands relative to the top left corner of its box,
+// reusing earlier layouts of the same text, or failing that the runs (words)
+// it consists of. Laying out "Value: 10" after "Value: 9" only has to deal with
+// the glyphs of "10".
+class TextLayoutCache
+{
+	public:
+		TextLayoutCache(std::size_t layouts = DEFAULT_TEXT_LAYOUT_CAPACITY, std::size_t runs = DEFAULT_TEXT_RUN_CAPACITY)
+			: m_layouts(layouts)
+			, m_runs(runs)
+			, m_generation(0)
+		{
+		}
+
+		// The result is valid until the next call
+		const std::vector<DrawCommand> &layout(const TextLayoutKey &key, GlyphCache &glyphs, uint font_height)
+		{
+			// Draw commands refer to glyphs by their place in the atlas, so nothing
+			// cached survives glyphs being evicted from it
+			if (glyphs.generation() != m_generation)
+			{
+				m_layouts.clear();
+				m_runs.clear();
+
+				m_generation = glyphs.generation();
+			}
+
+			if (const auto existing = m_layouts.find(key))
+			{
+				touch(*existing, glyphs);
+
+				return *existing;
+			}
+
+			std::vector<DrawCommand> commands;
+
+			long width = 0;
+
+			for (const auto &text : split_runs(key.text))
+			{
+				const auto &run = get_run({ text, key.font, key.size }, glyphs);
+
+				std::transform(std::begin(run.commands), std::end(run.commands), std::back_inserter(commands), [&](const DrawCommand &command)
+				{
+					return command.with_position(glm::vec2(command.position) + glm::vec2(width, 0));
+				});
+
+				width += run.width;
+			}
+
+			const auto &origin = glm::vec2(get_horizontal_offset(key, width), get_vertical_offset(key, font_height));
+
+			for (auto &command : commands)
+			{
+				command = command.with_position(glm::vec2(command.position) + origin);
+			}
+
+			return m_layouts.insert(key, commands);
+		}
+
+		TextLayoutStatistics statistics() const
+		{
+			return { m_layouts.statistics(), m_runs.statistics() };
+		}
+
+	private:
+		const TextRun &get_run(const TextRunKey &key, GlyphCache &glyphs)
+		{
+			if (const auto existing = m_runs.find(key))
+			{
+				touch(existing->commands, glyphs);
+
+				return *existing;
+			}
+
+			TextRun run { {}, 0 };
+
+			for (const auto codepoint : decode_utf8(key.text))
+			{
+				const auto &glyph = glyphs.get(key.font, key.size, codepoint);
+
+				run.commands.push_back(DrawCommand()
+					.with_uv(glyph.bounds / float(ATLAS_PAGE_SIZE))
+					.with_page(glyph.page)
+					.with_position(glm::vec2(run.width, glyph.offset))
+					.with_size(glm::vec2(glyph.bounds.z, glyph.bounds.w))
+					);
+
+				run.width += glyph.ax;
+			}
+
+			return m_runs.insert(key, run);
+		}
+
+		// Cached glyphs are used without going through the glyph cache, which
+		// still needs to know that their pages are in use
+		static void touch(const std::vector<DrawCommand> &commands, GlyphCache &glyphs)
+		{
+			for (const auto &command : commands)
+			{
+				if (command.textured())
+				{
+					glyphs.touch(command.page);
+				}
+			}
+		}
+
+		LruCache<TextLayoutKey, std::vector<DrawCommand>, TextLayoutKeyHash> m_layouts;
+		LruCache<TextRunKey, TextRun, TextRunKeyHash> m_runs;
+
+		uint64_t m_generation;
+};
+
+#endif // TEXTLAYOUT_H
@@ -0,0 +1,224 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed number of threads, each with a queue of its own. Threads take the
+// newest task from their own queue, and when it is empty, steal the oldest
+// task from the queue of another thread. Tasks are submitted in groups, and
+// whoever waits for a group runs tasks in the meantime, so tasks can submit
+// and wait for groups of their own without running out of threads.
+class ThreadPool
+{
+	public:
+		ThreadPool(std::size_t threads)
+			: m_queued(0)
+			, m_stopping(false)
+		{
+			for (std::size_t i = 0; i <= threads; i++)
+			{
+				m_queues.push_back(std::make_unique<Queue>());
+			}
+
+			for (std::size_t i = 0; i < threads; i++)
+			{
+				m_threads.emplace_back(&ThreadPool::work, this, i + 1);
+			}
+		}
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator =(const ThreadPool &) = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_stopping = true;
+			}
+
+			m_wake.notify_all();
+
+			for (auto &thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		// Runs "count" tasks, and returns once every one of them is done. The
+		// first task is run by the calling thread right away.
+		void run(const std::function<void()> *tasks, std::size_t count)
+		{
+			if (count == 0)
+			{
+				return;
+			}
+
+			std::atomic<std::size_t> pending(count - 1);
+
+			auto &queue = *m_queues[current()];
+
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+
+				for (std::size_t i = 1; i < count; i++)
+				{
+					queue.tasks.push_back({ &tasks[i], &pending });
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_queued += count - 1;
+			}
+
+			m_wake.notify_all();
+
+			tasks[0]();
+
+			while (pending > 0)
+			{
+				if (!run_one())
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		// Shared by every layout, with a thread less than there are cores, as
+		// the thread doing the layout takes part as well
+		static ThreadPool &layout()
+		{
+			static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+			return pool;
+		}
+
+	private:
+		struct Task
+		{
+			const std::function<void()> *function;
+
+			std::atomic<std::size_t> *pending;
+		};
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		// Queue of the calling thread, where threads outside of the pool share
+		// the first one
+		std::size_t current() const
+		{
+			return m_index < m_queues.size() ? m_index : 0;
+		}
+
+		bool pop(std::size_t index, Task &task, bool newest)
+		{
+			auto &queue = *m_queues[index];
+
+			std::lock_guard<std::mutex> lock(queue.mutex);
+
+			if (queue.tasks.empty())
+			{
+				return false;
+			}
+
+			if (newest)
+			{
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			}
+			else
+			{
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+
+			return true;
+		}
+
+		// Runs a task from the queue of this thread, or one stolen from another
+		bool run_one()
+		{
+			const auto own = current();
+
+			Task task;
+
+			auto found = pop(own, task, true);
+
+			for (std::size_t i = 1; !found && i < m_queues.size(); i++)
+			{
+				found = pop((own + i) % m_queues.size(), task, false);
+			}
+
+			if (!found)
+			{
+				return false;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_queued--;
+			}
+
+			(*task.function)();
+
+			(*task.pending)--;
+
+			return true;
+		}
+
+		void work(std::size_t index)
+		{
+			m_index = index;
+
+			while (true)
+			{
+				if (run_one())
+				{
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				m_wake.wait(lock, [this]
+				{
+					return m_stopping || m_queued > 0;
+				});
+
+				if (m_stopping)
+				{
+					return;
+				}
+			}
+		}
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_threads;
+
+		// Number of tasks waiting in any of the queues, for idle threads to
+		// sleep on
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::size_t m_queued;
+
+		bool m_stopping;
+
+		// Index of the queue of the pool thread running this, or 0
+		static inline thread_local std::size_t m_index = 0;
+};
+
+#endif // THREADPOOL_H
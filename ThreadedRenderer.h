@@ -0,0 +1,297 @@
+#ifndef THREADEDRENDERER_H
+#define THREADEDRENDERER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Common.h"
+#include "Timings.h"
+#include "Trace.h"
+
+// The pages of the glyph atlas that changed, copied off the glyph cache so
+// that they can be uploaded from another thread. It is handed to renderers
+// in place of the glyph cache itself.
+class GlyphUploads
+{
+	public:
+		GlyphUploads()
+			: m_page_count(0)
+		{
+		}
+
+		// Copies the changed pages of "glyphs", and marks them as uploaded there
+		void take(GlyphCache &glyphs)
+		{
+			m_page_count = glyphs.page_count();
+
+			glyphs.flush([this](uint page, const uint8_t *pixels, const Bounds &dirty)
+			{
+				auto &upload = find(page);
+
+				upload.pixels.assign(pixels, pixels + ATLAS_PAGE_BYTES);
+				upload.dirty = upload.dirty.united(dirty);
+			});
+		}
+
+		// Adds what "older" had yet to upload, underneath what is here already
+		void merge(GlyphUploads &&older)
+		{
+			for (auto &page : older.m_pages)
+			{
+				auto &upload = find(page.page);
+
+				if (upload.pixels.empty())
+				{
+					upload.pixels = std::move(page.pixels);
+				}
+
+				upload.dirty = upload.dirty.united(page.dirty);
+			}
+		}
+
+		std::size_t page_count() const
+		{
+			return m_page_count;
+		}
+
+		// Pages are always copied in full, so there is nothing to do here
+		void invalidate()
+		{
+		}
+
+		// Same as GlyphCache::flush
+		template<typename TUploader>
+		void flush(const TUploader &uploader)
+		{
+			for (const auto &page : m_pages)
+			{
+				uploader(page.page, page.pixels.data(), page.dirty);
+			}
+
+			m_pages.clear();
+		}
+
+	private:
+		struct PageUpload
+		{
+			uint page;
+
+			std::vector<uint8_t> pixels;
+
+			Bounds dirty;
+		};
+
+		PageUpload &find(uint page)
+		{
+			for (auto &upload : m_pages)
+			{
+				if (upload.page == page)
+				{
+					return upload;
+				}
+			}
+
+			m_pages.push_back({ page, {}, Bounds() });
+
+			return m_pages.back();
+		}
+
+		std::size_t m_page_count;
+
+		std::vector<PageUpload> m_pages;
+};
+
+// Every draw command of a frame, in the shape of a single drawable control
+struct FrameCommands
+{
+	immutable_vector<DrawCommand> draw_commands;
+};
+
+// Everything the render thread needs to paint a frame, without reading from
+// the state of the application
+struct RenderFrame
+{
+	FrameCommands commands;
+
+	Bounds damage;
+
+	GlyphUploads glyphs;
+};
+
+// Hands frames over to a thread of its own, where "TRenderer" paints and
+// presents them. Laying out the next frame then overlaps with waiting for the
+// previous one to be presented.
+//
+// Frames go through a single slot, where the latest frame wins. A frame that
+// is replaced before it was painted passes its damage and glyphs on to the
+// one replacing it, which is why frames carry all of their draw commands, and
+// not only the damaged ones.
+template<typename TRenderer>
+class ThreadedRenderer
+{
+	public:
+		ThreadedRenderer()
+			: m_mailbox(nullptr)
+			, m_ready(nullptr)
+			, m_stopping(false)
+			, m_uploaded_pages(0)
+			, m_uploaded_bytes(0)
+		{
+		}
+
+		ThreadedRenderer(const ThreadedRenderer &) = delete;
+		ThreadedRenderer &operator =(const ThreadedRenderer &) = delete;
+
+		// The window and context are created here, as SDL wants windows to be
+		// created on the main thread, and then handed over to the render thread
+		void create()
+		{
+			m_renderer.create();
+			m_renderer.release();
+
+			m_ready = SDL_CreateSemaphore(0);
+			m_stopping = false;
+			m_thread = std::thread(&ThreadedRenderer::render, this);
+		}
+
+		void destroy()
+		{
+			m_stopping = true;
+
+			SDL_SemPost(m_ready);
+
+			m_thread.join();
+
+			delete m_mailbox.exchange(nullptr);
+
+			SDL_DestroySemaphore(m_ready);
+
+			m_renderer.acquire();
+			m_renderer.destroy();
+		}
+
+		void upload_glyphs(GlyphCache &glyphs)
+		{
+			// The renderer might reallocate its pages when there are more of
+			// them, in which case every page needs to be uploaded again
+			if (glyphs.page_count() > m_uploaded_pages)
+			{
+				glyphs.invalidate();
+
+				m_uploaded_pages = glyphs.page_count();
+			}
+
+			m_glyphs.take(glyphs);
+		}
+
+		template<typename TDrawables>
+		void draw(const TDrawables &drawables, const Bounds &damage)
+		{
+			TRACE_SCOPE("extract_draw_commands");
+
+			m_commands = FrameCommands { extract_draw_commands(drawables) };
+			m_damage = m_damage.united(damage);
+		}
+
+		// As of the last frame painted by the render thread
+		GpuTimings gpu_timings() const
+		{
+			std::lock_guard<std::mutex> lock(m_timings_mutex);
+
+			return m_gpu_timings;
+		}
+
+		std::size_t uploaded_bytes() const
+		{
+			std::lock_guard<std::mutex> lock(m_timings_mutex);
+
+			return m_uploaded_bytes;
+		}
+
+		void present()
+		{
+			std::unique_ptr<RenderFrame> frame(new RenderFrame { std::move(m_commands), m_damage, std::move(m_glyphs) });
+
+			m_commands = FrameCommands();
+			m_damage = Bounds();
+			m_glyphs = GlyphUploads();
+
+			// Only this thread ever puts frames in the mailbox, so a frame taken
+			// back from it belongs to this thread until the new one is put there
+			std::unique_ptr<RenderFrame> replaced(m_mailbox.exchange(nullptr));
+
+			if (replaced)
+			{
+				frame->damage = frame->damage.united(replaced->damage);
+				frame->glyphs.merge(std::move(replaced->glyphs));
+			}
+
+			m_mailbox.store(frame.release());
+
+			SDL_SemPost(m_ready);
+		}
+
+	private:
+		void render()
+		{
+			m_renderer.acquire();
+
+			while (true)
+			{
+				SDL_SemWait(m_ready);
+
+				if (m_stopping)
+				{
+					break;
+				}
+
+				std::unique_ptr<RenderFrame> frame(m_mailbox.exchange(nullptr));
+
+				// Replaced frames leave a wake up behind them
+				if (!frame)
+				{
+					continue;
+				}
+
+				TRACE_SCOPE("render");
+
+				m_renderer.upload_glyphs(frame->glyphs);
+				m_renderer.draw(std::tie(frame->commands), frame->damage);
+				m_renderer.present();
+
+				const auto &timings = m_renderer.gpu_timings();
+
+				std::lock_guard<std::mutex> lock(m_timings_mutex);
+
+				m_gpu_timings = timings;
+				m_uploaded_bytes = m_renderer.uploaded_bytes();
+			}
+
+			m_renderer.release();
+		}
+
+		TRenderer m_renderer;
+
+		std::atomic<RenderFrame *> m_mailbox;
+
+		SDL_sem *m_ready;
+
+		std::atomic<bool> m_stopping;
+
+		std::thread m_thread;
+
+		// The frame being put together by the application
+		FrameCommands m_commands;
+		Bounds m_damage;
+		GlyphUploads m_glyphs;
+
+		std::size_t m_uploaded_pages;
+
+		mutable std::mutex m_timings_mutex;
+		GpuTimings m_gpu_timings;
+		std::size_t m_uploaded_bytes;
+};
+
+#endif // THREADEDRENDERER_H
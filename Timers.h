@@ -0,0 +1,155 @@
+#ifndef TIMERS_H
+#define TIMERS_H
+
+#include <unordered_map>
+
+#include "Common.h"
+
+enum class TimerMode
+{
+	Periodic,
+	Once
+};
+
+// The type of the events that timers push when they are due, registered with
+// SDL the first time it is asked for
+inline Uint32 tick_event_type()
+{
+	static const Uint32 type = SDL_RegisterEvents(1);
+
+	return type;
+}
+
+// Runs on the timer thread of SDL, where only pushing an event is safe. The
+// id of the timer and whether it repeats are packed into "param", so that
+// nothing is shared with the thread of the application.
+inline Uint32 push_tick(Uint32 interval, void *param)
+{
+	const auto key = reinterpret_cast<intptr_t>(param);
+
+	SDL_Event event {};
+	event.type = tick_event_type();
+	event.user.code = int(key >> 1);
+
+	SDL_PushEvent(&event);
+
+	return key & 1 ? interval : 0;
+}
+
+// Timers that transition the user state at a requested rate. When a timer is
+// due, an event is pushed to the event queue, which wakes up the application
+// loop, and the callback of the timer is applied to the user state when that
+// event is handled. Nothing is pushed while no timer is running, so the loop
+// can sleep.
+template<typename TUserState>
+class Timers
+{
+	public:
+		Timers()
+			: m_next(0)
+		{
+		}
+
+		Timers(const Timers &) = delete;
+		Timers &operator =(const Timers &) = delete;
+
+		~Timers()
+		{
+			clear();
+		}
+
+		// Calls "on_tick" every "interval" milliseconds, or once after that long.
+		// Returns an id for "stop", or -1 if the timer could not be started.
+		int start(Uint32 interval, Callback<TUserState> on_tick, TimerMode mode)
+		{
+			const auto id = m_next++;
+			const auto key = (intptr_t(id) << 1) | (mode == TimerMode::Periodic ? 1 : 0);
+
+			// Registered here, and not on the timer thread
+			tick_event_type();
+
+			const auto timer = SDL_AddTimer(interval, &push_tick, reinterpret_cast<void *>(key));
+
+			if (!timer)
+			{
+				return -1;
+			}
+
+			m_timers.emplace(id, Timer { timer, on_tick, mode });
+
+			return id;
+		}
+
+		// Ticks that were already pushed are ignored from here on
+		void stop(int id)
+		{
+			const auto existing = m_timers.find(id);
+
+			if (existing == std::end(m_timers))
+			{
+				return;
+			}
+
+			SDL_RemoveTimer(existing->second.timer);
+
+			m_timers.erase(existing);
+		}
+
+		// Stops every timer, which needs to happen before SDL is shut down
+		void clear()
+		{
+			for (const auto &timer : m_timers)
+			{
+				SDL_RemoveTimer(timer.second.timer);
+			}
+
+			m_timers.clear();
+		}
+
+		bool is_tick(const SDL_Event &event) const
+		{
+			return event.type == tick_event_type();
+		}
+
+		// Applies the callback of the timer that pushed "event" to "state"
+		TUserState tick(const TUserState &state, const SDL_Event &event)
+		{
+			if (!is_tick(event))
+			{
+				return state;
+			}
+
+			const auto existing = m_timers.find(event.user.code);
+
+			if (existing == std::end(m_timers))
+			{
+				return state;
+			}
+
+			const auto on_tick = existing->second.on_tick;
+
+			// SDL has already forgotten about timers that only fire once
+			if (existing->second.mode == TimerMode::Once)
+			{
+				m_timers.erase(existing);
+			}
+
+			return on_tick(state);
+		}
+
+	private:
+		struct Timer
+		{
+			SDL_TimerID timer;
+
+			Callback<TUserState> on_tick;
+
+			TimerMode mode;
+		};
+
+		std::unordered_map<int, Timer> m_timers;
+
+		int m_next;
+};
+
+#endif // TIMERS_H
@@ -0,0 +1,104 @@
+#ifndef TIMINGS_H
+#define TIMINGS_H
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Number of samples kept by a RollingTimings, covering a few seconds of frames
+constexpr std::size_t TIMING_WINDOW = 256;
+
+inline uint64_t timing_now()
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Percentiles of the samples of a RollingTimings, in nanoseconds
+struct TimingSummary
+{
+	TimingSummary()
+		: p50(0)
+		, p95(0)
+		, p99(0)
+		, samples(0)
+	{
+	}
+
+	uint64_t p50;
+	uint64_t p95;
+	uint64_t p99;
+
+	std::size_t samples;
+};
+
+// The last TIMING_WINDOW durations of something that happens every frame
+class RollingTimings
+{
+	public:
+		RollingTimings()
+			: m_samples(TIMING_WINDOW)
+			, m_recorded(0)
+		{
+		}
+
+		void record(uint64_t duration)
+		{
+			m_samples[m_recorded % TIMING_WINDOW] = duration;
+			m_recorded++;
+		}
+
+		TimingSummary summary() const
+		{
+			TimingSummary summary;
+
+			summary.samples = std::min(m_recorded, TIMING_WINDOW);
+
+			if (!summary.samples)
+			{
+				return summary;
+			}
+
+			auto sorted = std::vector<uint64_t>(m_samples.begin(), m_samples.begin() + std::ptrdiff_t(summary.samples));
+
+			const auto percentile = [&](std::size_t percent)
+			{
+				const auto nth = sorted.begin() + std::ptrdiff_t(std::min(summary.samples * percent / 100, summary.samples - 1));
+
+				std::nth_element(sorted.begin(), nth, sorted.end());
+
+				return *nth;
+			};
+
+			summary.p50 = percentile(50);
+			summary.p95 = percentile(95);
+			summary.p99 = percentile(99);
+
+			return summary;
+		}
+
+	private:
+		std::vector<uint64_t> m_samples;
+		std::size_t m_recorded;
+};
+
+// How long the GPU spent on each part of a frame
+struct GpuTimings
+{
+	TimingSummary clear;
+	TimingSummary draw;
+	TimingSummary present;
+};
+
+// How long frames take, on the CPU and on the GPU
+struct FrameTimings
+{
+	// From receiving the events to handing the frame to the renderer
+	TimingSummary frame;
+
+	// Handing the frame to the renderer, which is the CPU side of the GPU timings
+	TimingSummary render;
+
+	GpuTimings gpu;
+};
+
+#endif // TIMINGS_H
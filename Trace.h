@@ -0,0 +1,252 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Scoped timers around the phases of a frame and the logic of every control,
+// recorded when built with FOAM_TRACE defined, and written out as Chrome
+// trace events (for about:tracing or Perfetto) when the application exits.
+// Without FOAM_TRACE, TRACE_SCOPE expands to nothing, and its arguments are
+// never evaluated.
+
+#ifdef FOAM_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Context.h"
+
+// Events kept per thread, after which the oldest ones are overwritten
+constexpr std::size_t TRACE_CAPACITY = 1 << 16;
+
+struct TraceEvent
+{
+	const char *name;
+
+	// Level of the control, or -1 for phases of the frame
+	int id;
+
+	// In nanoseconds
+	uint64_t begin;
+	uint64_t end;
+};
+
+inline uint64_t trace_now()
+{
+	return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Ring of the events recorded by a single thread. Only that thread writes to
+// it, so recording takes no lock.
+class TraceBuffer
+{
+	public:
+		TraceBuffer(uint thread)
+			: m_thread(thread)
+			, m_events(TRACE_CAPACITY)
+			, m_written(0)
+		{
+		}
+
+		void record(const TraceEvent &event)
+		{
+			const auto written = m_written.load(std::memory_order_relaxed);
+
+			m_events[written % TRACE_CAPACITY] = event;
+			m_written.store(written + 1, std::memory_order_release);
+		}
+
+		// Hands the events that are still in the ring to "reader", oldest first.
+		// Events recorded meanwhile might be torn, so this is best done while
+		// the thread is idle.
+		template<typename TReader>
+		void read(const TReader &reader) const
+		{
+			const auto written = m_written.load(std::memory_order_acquire);
+			const auto first = written > TRACE_CAPACITY ? written - TRACE_CAPACITY : 0;
+
+			for (auto i = first; i < written; i++)
+			{
+				reader(m_events[i % TRACE_CAPACITY]);
+			}
+		}
+
+		uint thread() const
+		{
+			return m_thread;
+		}
+
+	private:
+		uint m_thread;
+
+		std::vector<TraceEvent> m_events;
+		std::atomic<std::size_t> m_written;
+};
+
+// The buffers of every thread that has recorded anything
+class Trace
+{
+	public:
+		static Trace &instance()
+		{
+			static Trace trace;
+
+			return trace;
+		}
+
+		// Buffer of the calling thread, which is only looked up the first time
+		TraceBuffer &buffer()
+		{
+			thread_local TraceBuffer *buffer = add_buffer();
+
+			return *buffer;
+		}
+
+		bool save(const std::string &path)
+		{
+			std::ofstream stream(path);
+
+			if (!stream)
+			{
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			// Timestamps are in microseconds, down to the nanosecond
+			stream << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+
+			auto first = true;
+
+			for (const auto &buffer : m_buffers)
+			{
+				buffer->read([&](const TraceEvent &event)
+				{
+					stream << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+						<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread()
+						<< ",\"ts\":" << event.begin / 1000.0
+						<< ",\"dur\":" << (event.end - event.begin) / 1000.0;
+
+					if (event.id >= 0)
+					{
+						stream << ",\"args\":{\"level\":" << event.id << "}";
+					}
+
+					stream << "}";
+
+					first = false;
+				});
+			}
+
+			stream << "\n]}\n";
+
+			return bool(stream);
+		}
+
+	private:
+		TraceBuffer *add_buffer()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_buffers.push_back(std::make_unique<TraceBuffer>(uint(m_buffers.size())));
+
+			return m_buffers.back().get();
+		}
+
+		std::mutex m_mutex;
+		std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+};
+
+// Records the time between its construction and destruction as "name"
+class TraceScope
+{
+	public:
+		TraceScope(const char *name, int id = -1)
+			: m_name(name)
+			, m_id(id)
+			, m_begin(trace_now())
+		{
+		}
+
+		TraceScope(const TraceScope &) = delete;
+		TraceScope &operator =(const TraceScope &) = delete;
+
+		~TraceScope()
+		{
+			Trace::instance().buffer().record({ m_name, m_id, m_begin, trace_now() });
+		}
+
+	private:
+		const char *m_name;
+
+		int m_id;
+
+		uint64_t m_begin;
+};
+
+constexpr const char *operation_name(Operation operation)
+{
+	switch (operation)
+	{
+		case Operation::Noop: return "Noop";
+		case Operation::Initialize: return "Initialize";
+		case Operation::Update: return "Update";
+		case Operation::Draw: return "Draw";
+		case Operation::Fused: return "Fused";
+	}
+
+	return "";
+}
+
+// The part of "signature" naming the template argument "TLogic"
+inline std::string parse_logic_name(const std::string &signature)
+{
+	const std::string key = "TLogic = ";
+
+	const auto begin = signature.find(key);
+
+	if (begin == std::string::npos)
+	{
+		return signature;
+	}
+
+	const auto end = signature.find_first_of(";]", begin);
+
+	return signature.substr(begin + key.size(), end - begin - key.size());
+}
+
+// Name of a logic template, such as "ButtonLogic", taken from the signature
+// of this function as the compiler spells it
+template<template<Operation> class TLogic>
+const char *logic_name()
+{
+	static const std::string name = parse_logic_name(__PRETTY_FUNCTION__);
+
+	return name.c_str();
+}
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(...) const TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(__VA_ARGS__)
+
+#else
+
+#define TRACE_SCOPE(...)
+
+#endif // FOAM_TRACE
+
+// Returns what "function" returns, timed as "name" when tracing, for phases
+// that are expressions rather than whole scopes
+template<typename TFunction>
+auto traced([[maybe_unused]] const char *name, const TFunction &function)
+{
+	TRACE_SCOPE(name);
+
+	return function();
+}
+
+#endif // TRACE_H
@@ -0,0 +1,138 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Substituted for anything that cannot be decoded
+constexpr char32_t REPLACEMENT_CHARACTER = 0xfffd;
+
+// Decodes the code point starting at "current", advancing past it. Malformed
+// sequences decode to REPLACEMENT_CHARACTER, consuming the lead byte and the
+// continuation bytes that were valid up to the point where decoding failed.
+inline char32_t decode_utf8_scalar(const uint8_t *&current, const uint8_t *end)
+{
+	const auto lead = *current++;
+
+	if (lead < 0x80)
+	{
+		return lead;
+	}
+
+	// Number of continuation bytes, and the range that the first one must be
+	// within, which rules out overlong encodings, surrogates and code points
+	// above U+10FFFF
+	int length;
+	uint8_t lower = 0x80;
+	uint8_t upper = 0xbf;
+
+	if (lead >= 0xc2 && lead <= 0xdf)
+	{
+		length = 1;
+	}
+	else if (lead >= 0xe0 && lead <= 0xef)
+	{
+		length = 2;
+		lower = lead == 0xe0 ? 0xa0 : 0x80;
+		upper = lead == 0xed ? 0x9f : 0xbf;
+	}
+	else if (lead >= 0xf0 && lead <= 0xf4)
+	{
+		length = 3;
+		lower = lead == 0xf0 ? 0x90 : 0x80;
+		upper = lead == 0xf4 ? 0x8f : 0xbf;
+	}
+	else
+	{
+		return REPLACEMENT_CHARACTER;
+	}
+
+	char32_t codepoint = lead & (0x3f >> length);
+
+	for (auto i = 0; i < length; i++)
+	{
+		if (current == end || *current < lower || *current > upper)
+		{
+			return REPLACEMENT_CHARACTER;
+		}
+
+		codepoint = (codepoint << 6) | (*current++ & 0x3f);
+
+		lower = 0x80;
+		upper = 0xbf;
+	}
+
+	return codepoint;
+}
+
+// Decodes "text" into code points, appending them to "target"
+void decode_utf8(const std::string &text, std::vector<char32_t> &target)
+{
+	const auto offset = target.size();
+
+	// Never more code points than bytes
+	target.resize(offset + text.size());
+
+	auto current = reinterpret_cast<const uint8_t *>(text.data());
+	auto output = target.data() + offset;
+
+	const auto end = current + text.size();
+
+#ifdef __SSE2__
+	const auto zero = _mm_setzero_si128();
+
+	// Blocks of pure ASCII are widened to code points 16 at a time, and only
+	// the rest goes through the scalar decoder
+	while (end - current >= 16)
+	{
+		const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+		const auto mask = _mm_movemask_epi8(block);
+
+		if (mask == 0)
+		{
+			const auto low = _mm_unpacklo_epi8(block, zero);
+			const auto high = _mm_unpackhi_epi8(block, zero);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + 0), _mm_unpacklo_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + 4), _mm_unpackhi_epi16(low, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + 8), _mm_unpacklo_epi16(high, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + 12), _mm_unpackhi_epi16(high, zero));
+
+			current += 16;
+			output += 16;
+
+			continue;
+		}
+
+		// Everything before the first byte with the high bit set is still ASCII
+		for (auto ascii = __builtin_ctz(uint(mask)); ascii > 0; ascii--)
+		{
+			*output++ = *current++;
+		}
+
+		*output++ = decode_utf8_scalar(current, end);
+	}
+#endif
+
+	while (current != end)
+	{
+		*output++ = decode_utf8_scalar(current, end);
+	}
+
+	target.resize(std::size_t(output - target.data()));
+}
+
+std::vector<char32_t> decode_utf8(const std::string &text)
+{
+	std::vector<char32_t> codepoints;
+
+	decode_utf8(text, codepoints);
+
+	return codepoints;
+}
+
+#endif // UTF8_H
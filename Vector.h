@@ -5,7 +5,10 @@
 #include <initializer_list>
 #include <algorithm>
 #include <memory>
+#include <vector>
 
+// Fixed contents, shared by every copy, which makes copying it as cheap as
+// copying a pointer
 template<typename T>
 class immutable_vector
 {
@@ -22,6 +25,13 @@ class immutable_vector
 			memcpy(m_storage.get(), &value, sizeof(T));
 		}
 
+		explicit immutable_vector(const std::vector<T> &vector)
+			: m_size(vector.size())
+			, m_storage(m_size ? new T[m_size] : nullptr)
+		{
+			std::copy(std::begin(vector), std::end(vector), m_storage.get());
+		}
+
 		immutable_vector(const std::initializer_list<T> &&initializer)
 			: m_size(initializer.size())
 			, m_storage(new T[m_size])
@@ -42,11 +52,26 @@ class immutable_vector
 			return m_size;
 		}
 
+		bool empty() const
+		{
+			return m_size == 0;
+		}
+
 		T *data() const
 		{
 			return m_storage.get();
 		}
 
+		const T *begin() const
+		{
+			return m_storage.get();
+		}
+
+		const T *end() const
+		{
+			return m_storage.get() + m_size;
+		}
+
 	private:
 		template<typename THead, typename ...TTail>
 		static void copy(T *target, const THead &head, const TTail &...tail)
@@ -63,7 +88,7 @@ class immutable_vector
 		}
 
 		std::size_t m_size;
-		std::shared_ptr<T> m_storage;
+		std::shared_ptr<T[]> m_storage;
 };
 
 #endif // VECTOR_H
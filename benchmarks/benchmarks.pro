@@ -0,0 +1,10 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    upload \
+    startup \
+    repack \
+    fused \
+    inert \
+    parallel \
+    hotpaths
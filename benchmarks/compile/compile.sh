@@ -0,0 +1,187 @@
+#!/bin/sh
+
+# Measures how compiling a layout scales with the number of controls in it.
+# For every count, a layout of that many rectangles is generated, once with
+# every rectangle in the layout itself, and once in islands of ISLAND_SIZE
+# rectangles. Both are compiled the way the benchmarks are, and the compile
+# time, the peak memory of the compiler and the size of the object file are
+# written to standard output as JSON.
+#
+# Usage: compile.sh [count...]
+#
+# CXX and CXXFLAGS are honored, and GNU time is needed for the peak memory.
+
+set -e
+
+COUNTS=${*:-10 100 250 500 1000}
+ISLAND_SIZE=${ISLAND_SIZE:-100}
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=$(mktemp -d)
+
+trap 'rm -rf "$WORK"' EXIT
+
+# The rectangles "first" up to "last", as they would appear in a layout, in
+# rows of ten, as children are built recursively and a single parent with
+# too many of them would exceed the template depth of the compiler
+rectangles()
+{
+	i=$1
+
+	while [ "$i" -lt "$2" ]
+	do
+		if [ $(( i % 10 )) -eq 0 ] || [ "$i" -eq "$1" ]
+		then
+			echo "			Rectangle"
+			echo "			{"
+		fi
+
+		echo "				Rectangle"
+		echo "				{"
+		echo "					position = glm::vec2($(( i % 40 * 20 )), $(( i / 40 % 30 * 20 ))),"
+		echo "					size = glm::vec2(18, 18),"
+		echo "					color = 0xff$(printf '%06x' $(( i * 2654435761 % 16777216 )))"
+		echo "				},"
+
+		i=$(( i + 1 ))
+
+		if [ $(( i % 10 )) -eq 0 ] || [ "$i" -eq "$2" ]
+		then
+			echo "				size = glm::vec2(SCREEN_WIDTH, 20)"
+			echo "			},"
+		fi
+	done
+}
+
+# A whole program laying out "count" rectangles, in islands if "islands" is 1
+generate()
+{
+	cat <<-END
+	#include "Application.h"
+	#include "SoftwareRenderer.h"
+	#include "Rectangle.h"
+	#include "Island.h"
+	#include "DefaultStyle.h"
+
+	struct State
+	{
+	};
+
+	END
+
+	islands=0
+
+	if [ "$2" -eq 1 ]
+	then
+		while [ $(( islands * ISLAND_SIZE )) -lt "$1" ]
+		do
+			last=$(( (islands + 1) * ISLAND_SIZE ))
+			last=$(( last < $1 ? last : $1 ))
+
+			echo "struct Island$islands"
+			echo "{"
+			echo "	static auto layout(const State &)"
+			echo "	{"
+			echo "		return Rectangle"
+			echo "		{"
+			rectangles $(( islands * ISLAND_SIZE )) $last
+			echo "			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT)"
+			echo "		};"
+			echo "	}"
+			echo "};"
+			echo
+
+			islands=$(( islands + 1 ))
+		done
+	fi
+
+	cat <<-END
+	struct Screen;
+
+	using ScreenApplication = Application<Screen, State, DefaultStyle, SoftwareRenderer>;
+
+	struct Screen : public ScreenApplication
+	{
+	END
+	echo "	static auto layout(const State &)"
+	echo "	{"
+	echo "		return Rectangle"
+	echo "		{"
+
+	if [ "$2" -eq 1 ]
+	then
+		i=0
+
+		while [ "$i" -lt "$islands" ]
+		do
+			echo "			Island<Island$i>(),"
+			i=$(( i + 1 ))
+		done
+	else
+		rectangles 0 "$1"
+	fi
+
+	echo "			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT)"
+	echo "		};"
+	echo "	}"
+	echo "};"
+	echo
+
+	cat <<-END
+	int main()
+	{
+	END
+	echo "	Screen screen;"
+	echo
+	echo "	// The layout of Screen hides the passes of Application"
+	echo "	ScreenApplication &application = screen;"
+	echo
+	echo "	const auto &initial = application.layout<Operation::Initialize>(std::make_tuple(RootState(), State()));"
+	echo "	const auto &updated = application.layout<Operation::Update>(initial);"
+	echo "	const auto &drawn = application.layout<Operation::Draw>(updated);"
+	echo "	const auto &fused = application.layout<Operation::Fused>(drawn);"
+	echo
+	echo "	return int(std::get<RootState>(fused).hash);"
+	echo "}"
+}
+
+echo "{\"results\":["
+
+separator=""
+
+for count in $COUNTS
+do
+	for islands in 0 1
+	do
+		source="$WORK/layout.cpp"
+		object="$WORK/layout.o"
+		layout=$([ "$islands" -eq 1 ] && echo islands || echo flat)
+
+		generate "$count" "$islands" > "$source"
+
+		rm -f "$object"
+
+		# Elapsed seconds and peak memory in kilobytes
+		if /usr/bin/time -f "%e %M" -o "$WORK/time" "$CXX" -std=c++17 $CXXFLAGS \
+			-I"$ROOT" -I/usr/include/SDL2 $(pkg-config --cflags freetype2) -Wa,-I"$ROOT" \
+			-c "$source" -o "$object" 2> "$WORK/errors"
+		then
+			read -r seconds peak < "$WORK/time"
+
+			printf '%s\n{"controls":%s,"layout":"%s","seconds":%s,"peak_kb":%s,"object_bytes":%s}' \
+				"$separator" "$count" "$layout" "$seconds" "$peak" "$(wc -c < "$object")"
+		else
+			echo "$count $layout: $(head -n 5 "$WORK/errors")" >&2
+
+			printf '%s\n{"controls":%s,"layout":"%s","failed":true}' "$separator" "$count" "$layout"
+		fi
+
+		separator=","
+	done
+done
+
+echo
+echo "]}"
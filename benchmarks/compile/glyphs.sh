@@ -0,0 +1,83 @@
+#!/bin/sh
+
+# Compares the time it takes to compile the glyph table builder GlyphCache
+# replaced (create_glyphs, see benchmarks/startup/LegacyGlyphs.h) with
+# GlyphCache::prewarm, which builds the same glyphs. Both translation units
+# include the same headers and only differ in the builder they call. The
+# compile time, the peak memory of the compiler and the size of the object
+# file of each are written to standard output as JSON.
+#
+# Usage: glyphs.sh
+#
+# CXX and CXXFLAGS are honored, and GNU time is needed for the peak memory.
+
+set -e
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--O2}
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+WORK=$(mktemp -d)
+
+trap 'rm -rf "$WORK"' EXIT
+
+# A translation unit building the glyphs of printable ASCII with "builder"
+generate()
+{
+	cat <<-END
+	#include "GlyphCache.h"
+	#include "LegacyGlyphs.h"
+
+	std::size_t build(GlyphCache &glyphs, FT_Face face)
+	{
+	END
+
+	if [ "$1" = "create_glyphs" ]
+	then
+		echo "	(void)glyphs;"
+		echo
+		echo "	return legacy::create_glyphs<33, 128>::value(face, 0, 0).size();"
+	else
+		echo "	(void)face;"
+		echo
+		echo "	glyphs.prewarm(0, 11, 32, 127);"
+		echo
+		echo "	return glyphs.page_count();"
+	fi
+
+	echo "}"
+}
+
+echo "{\"results\":["
+
+separator=""
+
+for builder in create_glyphs prewarm
+do
+	source="$WORK/glyphs.cpp"
+	object="$WORK/glyphs.o"
+
+	generate "$builder" > "$source"
+
+	rm -f "$object"
+
+	# Elapsed seconds and peak memory in kilobytes
+	if /usr/bin/time -f "%e %M" -o "$WORK/time" "$CXX" -std=c++17 $CXXFLAGS \
+		-I"$ROOT" -I"$ROOT/benchmarks/startup" $(pkg-config --cflags freetype2) \
+		-c "$source" -o "$object" 2> "$WORK/errors"
+	then
+		read -r seconds peak < "$WORK/time"
+
+		printf '%s\n{"builder":"%s","seconds":%s,"peak_kb":%s,"object_bytes":%s}' \
+			"$separator" "$builder" "$seconds" "$peak" "$(wc -c < "$object")"
+	else
+		echo "$builder: $(head -n 5 "$WORK/errors")" >&2
+
+		printf '%s\n{"builder":"%s","failed":true}' "$separator" "$builder"
+	fi
+
+	separator=","
+done
+
+echo
+echo "]}"
@@ -0,0 +1,154 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "Application.h"
+#include "SoftwareRenderer.h"
+#include "Rectangle.h"
+#include "DefaultStyle.h"
+
+// Compares the time it takes to deliver an event and draw the result, with
+// separate Update and Draw passes over the layout and with a single fused pass.
+// The layout is made of 500 rectangles, of which only a few change from one
+// frame to the next, so the traversal itself is most of what is measured.
+//
+// Usage: fused [frames]
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t ROWS = 20;
+constexpr std::size_t COLUMNS = 25;
+
+struct State
+{
+	State()
+		: frame(0)
+		, changed(0)
+	{
+	}
+
+	// Controls before this index get a new color every frame
+	State with_changed(std::size_t changed) const
+	{
+		State copy(*this);
+		copy.changed = changed;
+
+		return copy;
+	}
+
+	uint color(std::size_t index) const
+	{
+		return index < changed
+			? 0xff000000 | uint(frame * 2654435761u)
+			: 0xffcccccc;
+	}
+
+	std::size_t frame;
+	std::size_t changed;
+};
+
+struct Benchmark;
+
+using BenchmarkApplication = Application<Benchmark, State, DefaultStyle, SoftwareRenderer>;
+
+struct Benchmark : public BenchmarkApplication
+{
+	State update_state(const State &state) override
+	{
+		State copy(state);
+		copy.frame++;
+
+		return copy;
+	}
+
+	template<std::size_t TRow, std::size_t ...TColumn>
+	static auto row(const State &state, std::index_sequence<TColumn...>)
+	{
+		return Rectangle
+		{
+			position = glm::vec2(0, TRow * 30),
+			size = glm::vec2(800, 30),
+			color = 0xffffffff,
+
+			Rectangle
+			{
+				position = glm::vec2(TColumn * 32, TRow * 30),
+				size = glm::vec2(30, 28),
+				color = state.color(TRow * COLUMNS + TColumn)
+			}...
+		};
+	}
+
+	template<std::size_t ...TRow>
+	static auto grid(const State &state, std::index_sequence<TRow...>)
+	{
+		return Rectangle
+		{
+			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT),
+			color = 0xfffcfcfc,
+
+			row<TRow>(state, std::make_index_sequence<COLUMNS>())...
+		};
+	}
+
+	static auto layout(const State &state)
+	{
+		return grid(state, std::make_index_sequence<ROWS>());
+	}
+};
+
+template<typename TPass>
+double measure(int frames, const TPass &pass)
+{
+	const auto start = Clock::now();
+
+	for (int i = 0; i < frames; i++)
+	{
+		pass();
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+	return elapsed.count() / frames;
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+	Benchmark benchmark;
+
+	// The layout of Benchmark hides the passes of Application
+	BenchmarkApplication &application = benchmark;
+
+	// Nothing here draws text, so the root state can do without fonts
+	const auto &initial = application.layout<Operation::Initialize>(std::make_tuple(RootState(), State()));
+
+	SDL_Event event {};
+	event.type = SDL_MOUSEMOTION;
+
+	std::cout << "controls: " << ROWS * COLUMNS << std::endl;
+
+	for (const std::size_t changed : { 0, 10, 500 })
+	{
+		auto state = repack(initial, std::get<State>(initial).with_changed(changed));
+
+		// Draw once, so that unchanged controls have draw commands to keep
+		state = application.layout<Operation::Draw>(state);
+
+		const auto separate = measure(frames, [&]
+		{
+			state = application.layout<Operation::Draw>(application.update(state, event));
+		});
+
+		const auto fused = measure(frames, [&]
+		{
+			state = application.layout<Operation::Fused>(application.prepare(state, event));
+		});
+
+		std::cout << "changed: " << changed << std::endl;
+		std::cout << "  update, then draw: " << separate << " ms per frame" << std::endl;
+		std::cout << "  fused: " << fused << " ms per frame" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,360 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "Application.h"
+#include "SoftwareRenderer.h"
+#include "Rectangle.h"
+#include "Text.h"
+#include "Button.h"
+#include "DefaultStyle.h"
+
+// Times the paths that every frame goes through, over layouts of 10, 100 and
+// 1000 rectangles, texts or buttons (in rows of ten, each row being a
+// rectangle of its own), where every control changes every frame:
+//
+// * update, draw - the Update and Draw passes of Application::layout
+// * repack - putting a single state back into the state of the whole layout
+// * tuple_filter - picking the drawable controls out of that state
+// * compute_hash - hashing the draw commands of the drawable controls
+// * extract_draw_commands - gathering the draw commands for the renderer
+// * text_layout - laying out the glyphs of a text, as TextLogic does, for texts
+//
+// Results are written to standard output as JSON, in nanoseconds per control
+// and allocations per frame, to be compared between commits.
+//
+// Usage: hotpaths [frames] [font]
+
+FOAM_COUNT_ALLOCATIONS
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t COLUMNS = 10;
+
+enum class Kind
+{
+	Rectangle,
+	Text,
+	Button
+};
+
+constexpr const char *kind_name(Kind kind)
+{
+	switch (kind)
+	{
+		case Kind::Rectangle: return "rectangle";
+		case Kind::Text: return "text";
+		case Kind::Button: return "button";
+	}
+
+	return "";
+}
+
+struct State
+{
+	State()
+		: frame(0)
+	{
+	}
+
+	State next() const
+	{
+		State copy(*this);
+		copy.frame++;
+
+		return copy;
+	}
+
+	uint color(std::size_t index) const
+	{
+		return 0xff000000 | uint((frame + index) * 2654435761u);
+	}
+
+	std::string text(std::size_t index) const
+	{
+		return "Value " + std::to_string(frame + index);
+	}
+
+	std::size_t frame;
+};
+
+template<typename T>
+using DrawablePredicate = std::is_base_of<DrawableControl, T>;
+
+template<Kind TKind, std::size_t TCount>
+struct Benchmark;
+
+template<Kind TKind, std::size_t TCount>
+using BenchmarkApplication = Application<Benchmark<TKind, TCount>, State, DefaultStyle, SoftwareRenderer>;
+
+template<Kind TKind, std::size_t TCount>
+struct Benchmark : public BenchmarkApplication<TKind, TCount>
+{
+	static State clicked(const State &state)
+	{
+		return state;
+	}
+
+	static auto control(const State &state, std::size_t index)
+	{
+		// Not to be confused with the properties of the same name
+		const auto &at = glm::vec2((index % COLUMNS) * 80, (index / COLUMNS % 40) * 15);
+		const auto &extent = glm::vec2(78, 14);
+
+		if constexpr (TKind == Kind::Rectangle)
+		{
+			return Rectangle
+			{
+				position = at,
+				size = extent,
+				color = state.color(index)
+			};
+		}
+		else if constexpr (TKind == Kind::Text)
+		{
+			return Text
+			{
+				position = at,
+				size = extent,
+				color = 0xff000000,
+				text = state.text(index)
+			};
+		}
+		else
+		{
+			return Button
+			{
+				position = at,
+				size = extent,
+				on_clicked = &clicked,
+				text = state.text(index)
+			};
+		}
+	}
+
+	template<std::size_t TRow, std::size_t ...TColumn>
+	static auto row(const State &state, std::index_sequence<TColumn...>)
+	{
+		return Rectangle
+		{
+			position = glm::vec2(0, (TRow % 40) * 15),
+			size = glm::vec2(800, 15),
+			color = 0xffffffff,
+
+			control(state, TRow * COLUMNS + TColumn)...
+		};
+	}
+
+	template<std::size_t ...TRow>
+	static auto grid(const State &state, std::index_sequence<TRow...>)
+	{
+		return Rectangle
+		{
+			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT),
+			color = 0xfffcfcfc,
+
+			row<TRow>(state, std::make_index_sequence<COLUMNS>())...
+		};
+	}
+
+	static auto layout(const State &state)
+	{
+		return grid(state, std::make_index_sequence<TCount / COLUMNS>());
+	}
+};
+
+struct Measurement
+{
+	double nanoseconds;
+	double allocations;
+};
+
+// Runs "path" once per frame, after "prepare", which is left out of the
+// measurement
+template<typename TPrepare, typename TPath>
+Measurement measure(int frames, const TPrepare &prepare, const TPath &path)
+{
+	Clock::duration elapsed(0);
+	uint64_t allocations = 0;
+
+	for (int i = 0; i < frames; i++)
+	{
+		prepare();
+
+		const auto allocations_before = allocation_count();
+		const auto start = Clock::now();
+
+		path();
+
+		elapsed += Clock::now() - start;
+		allocations += allocation_count() - allocations_before;
+	}
+
+	const std::chrono::duration<double, std::nano> nanoseconds = elapsed;
+
+	return
+	{
+		nanoseconds.count() / frames,
+		double(allocations) / frames,
+	};
+}
+
+class Report
+{
+	public:
+		Report()
+			: m_first(true)
+		{
+			std::cout << "{\"results\":[";
+		}
+
+		~Report()
+		{
+			std::cout << "\n]}" << std::endl;
+		}
+
+		void add(Kind kind, std::size_t count, const char *path, const Measurement &measurement)
+		{
+			std::cout << (m_first ? "" : ",")
+				<< "\n{\"control\":\"" << kind_name(kind)
+				<< "\",\"count\":" << count
+				<< ",\"path\":\"" << path
+				<< "\",\"ns_per_control\":" << measurement.nanoseconds / count
+				<< ",\"allocations_per_frame\":" << measurement.allocations
+				<< "}";
+
+			m_first = false;
+		}
+
+	private:
+		bool m_first;
+};
+
+static volatile uint64_t sink;
+
+template<Kind TKind, std::size_t TCount>
+void run(int frames, const RootState &root, Report &report)
+{
+	Benchmark<TKind, TCount> benchmark;
+
+	// The layout of Benchmark hides the passes of Application
+	BenchmarkApplication<TKind, TCount> &application = benchmark;
+
+	const auto nothing = [] {};
+
+	auto state = application.template layout<Operation::Initialize>(std::make_tuple(root, State()));
+
+	const auto next = [&]
+	{
+		const auto &user = std::get<State>(state).next();
+
+		state = repack(std::move(state), user);
+	};
+
+	const auto update = [&]
+	{
+		state = application.template layout<Operation::Update>(std::move(state));
+	};
+
+	const auto draw = [&]
+	{
+		root.glyphs->begin_frame();
+
+		state = application.template layout<Operation::Draw>(std::move(state));
+	};
+
+	report.add(TKind, TCount, "update", measure(frames, next, update));
+
+	report.add(TKind, TCount, "draw", measure(frames, [&]
+	{
+		next();
+		update();
+	}, draw));
+
+	RootState current;
+
+	report.add(TKind, TCount, "repack", measure(frames, [&]
+	{
+		current = std::get<RootState>(state);
+	}, [&]
+	{
+		state = repack(std::move(state), current);
+	}));
+
+	auto drawables = tuple_filter<DrawablePredicate>(state);
+
+	report.add(TKind, TCount, "tuple_filter", measure(frames, nothing, [&]
+	{
+		drawables = tuple_filter<DrawablePredicate>(state);
+	}));
+
+	report.add(TKind, TCount, "compute_hash", measure(frames, nothing, [&]
+	{
+		sink = compute_hash(drawables);
+	}));
+
+	report.add(TKind, TCount, "extract_draw_commands", measure(frames, nothing, [&]
+	{
+		sink = extract_draw_commands(drawables).size();
+	}));
+
+	if constexpr (TKind == Kind::Text)
+	{
+		std::vector<TextLayoutKey> keys;
+		std::size_t frame = 0;
+
+		// New texts every frame, which share most of their words with the
+		// texts of the frame before, as a counter would
+		report.add(TKind, TCount, "text_layout", measure(frames, [&]
+		{
+			keys.clear();
+			frame++;
+
+			for (std::size_t i = 0; i < TCount; i++)
+			{
+				keys.push_back({ "Value " + std::to_string(frame + i), DEFAULT_FONT, DEFAULT_FONT_SIZE, AlignLeft | AlignTop, glm::vec2(78, 14) });
+			}
+
+			root.glyphs->begin_frame();
+		}, [&]
+		{
+			for (const auto &key : keys)
+			{
+				sink = root.layouts->layout(key, *root.glyphs, root.font_height).size();
+			}
+		}));
+	}
+}
+
+template<Kind TKind>
+void run(int frames, const RootState &root, Report &report)
+{
+	run<TKind, 10>(frames, root, report);
+	run<TKind, 100>(frames, root, report);
+	run<TKind, 1000>(frames, root, report);
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 100;
+	const std::string font = argc > 2 ? argv[2] : DEFAULT_FONT_PATH;
+
+	RootState root;
+	root.glyphs = std::make_shared<GlyphCache>();
+	root.layouts = std::make_shared<TextLayoutCache>();
+
+	if (root.glyphs->add_font(font) == NO_FONT)
+	{
+		std::cerr << "Could not read " << font << std::endl;
+
+		return 1;
+	}
+	root.font_height = root.glyphs->line_height(DEFAULT_FONT, DEFAULT_FONT_SIZE);
+
+	Report report;
+
+	run<Kind::Rectangle>(frames, root, report);
+	run<Kind::Text>(frames, root, report);
+	run<Kind::Button>(frames, root, report);
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "Application.h"
+#include "SoftwareRenderer.h"
+#include "Rectangle.h"
+#include "TextBox.h"
+#include "DefaultStyle.h"
+
+// Moves the pointer around a window where a few text boxes take up a small
+// part of the screen, and counts the frames that were skipped because no
+// control reacted to the pointer. Those are compared with laying out and
+// drawing every frame regardless.
+//
+// Usage: inert [frames]
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t ROWS = 4;
+constexpr std::size_t COLUMNS = 3;
+
+struct State
+{
+};
+
+struct Benchmark;
+
+using BenchmarkApplication = Application<Benchmark, State, DefaultStyle, SoftwareRenderer>;
+
+struct Benchmark : public BenchmarkApplication
+{
+	template<std::size_t TRow, std::size_t ...TColumn>
+	static auto row(std::index_sequence<TColumn...>)
+	{
+		return Rectangle
+		{
+			position = glm::vec2(0, TRow * 40),
+			size = glm::vec2(800, 40),
+			color = 0xfffcfcfc,
+
+			TextBox
+			{
+				position = glm::vec2(10 + TColumn * 160, 10 + TRow * 40),
+				size = glm::vec2(150, 30)
+			}...
+		};
+	}
+
+	template<std::size_t ...TRow>
+	static auto grid(std::index_sequence<TRow...>)
+	{
+		return Rectangle
+		{
+			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT),
+			color = 0xfffcfcfc,
+
+			row<TRow>(std::make_index_sequence<COLUMNS>())...
+		};
+	}
+
+	static auto layout(const State &)
+	{
+		return grid(std::make_index_sequence<ROWS>());
+	}
+};
+
+// Somewhere on the screen, the same sequence every run
+SDL_Event next_event(uint32_t &seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+
+	SDL_Event event {};
+	event.type = SDL_MOUSEMOTION;
+	event.motion.x = int(seed >> 8) % SCREEN_WIDTH;
+	event.motion.y = int(seed >> 20) % SCREEN_HEIGHT;
+
+	return event;
+}
+
+template<typename TPass>
+double measure(int frames, const TPass &pass)
+{
+	uint32_t seed = 1;
+
+	const auto start = Clock::now();
+
+	for (int i = 0; i < frames; i++)
+	{
+		pass(next_event(seed));
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+	return elapsed.count() / frames;
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+	Benchmark benchmark;
+
+	// The layout of Benchmark hides the passes of Application
+	BenchmarkApplication &application = benchmark;
+
+	// Nothing here draws text, so the glyph cache can do without fonts
+	RootState root;
+	root.glyphs = std::make_shared<GlyphCache>();
+
+	application.m_renderer.create();
+
+	const auto &initial = application.layout<Operation::Initialize>(std::make_tuple(root, State()));
+
+	SDL_Event first {};
+	first.type = SDL_WINDOWEVENT;
+
+	// Paint once, so that the controls know where they are
+	auto state = application.frame(initial, first);
+	auto always = state;
+
+	const auto skipped_before = std::get<RootState>(state).statistics.skipped;
+
+	const auto skipping = measure(frames, [&](const SDL_Event &event)
+	{
+		state = application.frame(state, event);
+	});
+
+	const auto laid_out = measure(frames, [&](const SDL_Event &event)
+	{
+		always = application.layout<Operation::Draw>(application.update(always, event));
+	});
+
+	const auto skipped = std::get<RootState>(state).statistics.skipped - skipped_before;
+
+	std::cout << "controls: " << ROWS * COLUMNS << " text boxes" << std::endl;
+	std::cout << "skipped: " << skipped << " of " << frames << " frames" << std::endl;
+	std::cout << "  skipping inert frames: " << skipping << " ms per frame" << std::endl;
+	std::cout << "  laying out every frame: " << laid_out << " ms per frame" << std::endl;
+
+	application.m_renderer.destroy();
+
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cstdlib>
+
+#include "Application.h"
+#include "SoftwareRenderer.h"
+#include "Rectangle.h"
+#include "Parallel.h"
+#include "DefaultStyle.h"
+
+// Compares the time of the Update and Draw passes over 2000 rectangles, with
+// the rows of rectangles built one after the other, and on the layout thread
+// pool through Parallel. Every rectangle changes color every frame, so that
+// there is work to share.
+//
+// Usage: parallel [frames]
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t ROWS = 40;
+constexpr std::size_t COLUMNS = 50;
+
+struct State
+{
+	State()
+		: frame(0)
+	{
+	}
+
+	uint color(std::size_t index) const
+	{
+		return 0xff000000 | uint((frame + index) * 2654435761u);
+	}
+
+	std::size_t frame;
+};
+
+template<bool TParallel>
+struct Benchmark;
+
+template<bool TParallel>
+using BenchmarkApplication = Application<Benchmark<TParallel>, State, DefaultStyle, SoftwareRenderer>;
+
+template<bool TParallel>
+struct Benchmark : public BenchmarkApplication<TParallel>
+{
+	State update_state(const State &state) override
+	{
+		State copy(state);
+		copy.frame++;
+
+		return copy;
+	}
+
+	template<std::size_t TRow, std::size_t ...TColumn>
+	static auto row(const State &state, std::index_sequence<TColumn...>)
+	{
+		return Rectangle
+		{
+			position = glm::vec2(0, TRow * 15),
+			size = glm::vec2(800, 15),
+			color = 0xffffffff,
+
+			Rectangle
+			{
+				position = glm::vec2(TColumn * 16, TRow * 15),
+				size = glm::vec2(15, 14),
+				color = state.color(TRow * COLUMNS + TColumn)
+			}...
+		};
+	}
+
+	template<std::size_t ...TRow>
+	static auto rows(const State &state, std::index_sequence<TRow...>)
+	{
+		if constexpr (TParallel)
+		{
+			return Parallel
+			{
+				row<TRow>(state, std::make_index_sequence<COLUMNS>())...
+			};
+		}
+		else
+		{
+			return Rectangle
+			{
+				row<TRow>(state, std::make_index_sequence<COLUMNS>())...
+			};
+		}
+	}
+
+	static auto layout(const State &state)
+	{
+		return Rectangle
+		{
+			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT),
+			color = 0xfffcfcfc,
+
+			rows(state, std::make_index_sequence<ROWS>())
+		};
+	}
+};
+
+template<bool TParallel>
+double measure(int frames)
+{
+	Benchmark<TParallel> benchmark;
+
+	// The layout of Benchmark hides the passes of Application
+	BenchmarkApplication<TParallel> &application = benchmark;
+
+	SDL_Event event {};
+	event.type = SDL_MOUSEMOTION;
+
+	auto state = application.template layout<Operation::Initialize>(std::make_tuple(RootState(), State()));
+
+	const auto start = Clock::now();
+
+	for (int i = 0; i < frames; i++)
+	{
+		state = application.template layout<Operation::Draw>(application.update(state, event));
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+	return elapsed.count() / frames;
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 200;
+
+	std::cout << "controls: " << ROWS * COLUMNS << ", threads: " << std::thread::hardware_concurrency() << std::endl;
+	std::cout << "  in order: " << measure<false>(frames) << " ms per frame" << std::endl;
+	std::cout << "  parallel: " << measure<true>(frames) << " ms per frame" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,14 @@
+TEMPLATE = app
+TARGET = parallel
+INCLUDEPATH += ../.. /usr/include/SDL2
+CONFIG += c++17 link_pkgconfig thread
+CONFIG -= qt
+
+# Let the assembler find the shaders embedded through incbin.h
+QMAKE_CXXFLAGS += -Wa,-I$$PWD/../..
+
+SOURCES += main.cpp
+
+LIBS += -lSDL2 -lSDL2main -lGLEW -lGL
+
+PKGCONFIG += freetype2
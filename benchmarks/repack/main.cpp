@@ -0,0 +1,204 @@
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "Application.h"
+#include "SoftwareRenderer.h"
+#include "Rectangle.h"
+#include "DefaultStyle.h"
+
+// Counts the heap allocations (and bytes) made while running the Update and
+// Draw passes over a layout of 500 rectangles, of which only a few change
+// from one frame to the next. With the state moved from control to control,
+// both should follow the number of changed controls, not the size of the layout.
+//
+// Usage: repack [frames]
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t ROWS = 20;
+constexpr std::size_t COLUMNS = 25;
+
+static std::size_t allocations = 0;
+static std::size_t allocated_bytes = 0;
+
+void *operator new(std::size_t size)
+{
+	allocations++;
+	allocated_bytes += size;
+
+	if (const auto pointer = std::malloc(size))
+	{
+		return pointer;
+	}
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+struct State
+{
+	State()
+		: frame(0)
+		, changed(0)
+	{
+	}
+
+	// Controls before this index get a new color every frame
+	State with_changed(std::size_t changed) const
+	{
+		State copy(*this);
+		copy.changed = changed;
+
+		return copy;
+	}
+
+	uint color(std::size_t index) const
+	{
+		return index < changed
+			? 0xff000000 | uint(frame * 2654435761u)
+			: 0xffcccccc;
+	}
+
+	std::size_t frame;
+	std::size_t changed;
+};
+
+struct Benchmark;
+
+using BenchmarkApplication = Application<Benchmark, State, DefaultStyle, SoftwareRenderer>;
+
+struct Benchmark : public BenchmarkApplication
+{
+	State update_state(const State &state) override
+	{
+		State copy(state);
+		copy.frame++;
+
+		return copy;
+	}
+
+	template<std::size_t TRow, std::size_t ...TColumn>
+	static auto row(const State &state, std::index_sequence<TColumn...>)
+	{
+		return Rectangle
+		{
+			position = glm::vec2(0, TRow * 30),
+			size = glm::vec2(800, 30),
+			color = 0xffffffff,
+
+			Rectangle
+			{
+				position = glm::vec2(TColumn * 32, TRow * 30),
+				size = glm::vec2(30, 28),
+				color = state.color(TRow * COLUMNS + TColumn)
+			}...
+		};
+	}
+
+	template<std::size_t ...TRow>
+	static auto grid(const State &state, std::index_sequence<TRow...>)
+	{
+		return Rectangle
+		{
+			size = glm::vec2(SCREEN_WIDTH, SCREEN_HEIGHT),
+			color = 0xfffcfcfc,
+
+			row<TRow>(state, std::make_index_sequence<COLUMNS>())...
+		};
+	}
+
+	static auto layout(const State &state)
+	{
+		return grid(state, std::make_index_sequence<ROWS>());
+	}
+};
+
+struct Measurement
+{
+	double allocations;
+	double bytes;
+	double milliseconds;
+};
+
+template<typename TPass>
+Measurement measure(int frames, const TPass &pass)
+{
+	const auto allocations_before = allocations;
+	const auto bytes_before = allocated_bytes;
+	const auto start = Clock::now();
+
+	for (int i = 0; i < frames; i++)
+	{
+		pass();
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+	return
+	{
+		double(allocations - allocations_before) / frames,
+		double(allocated_bytes - bytes_before) / frames,
+		elapsed.count() / frames,
+	};
+}
+
+void print(const char *name, const Measurement &measurement)
+{
+	std::cout << "  " << name << ": "
+		<< measurement.allocations << " allocations, "
+		<< measurement.bytes << " bytes, "
+		<< measurement.milliseconds << " ms per frame" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	const int frames = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+	Benchmark benchmark;
+
+	// The layout of Benchmark hides the passes of Application
+	BenchmarkApplication &application = benchmark;
+
+	// Nothing here draws text, so the root state can do without fonts
+	const auto &initial = application.layout<Operation::Initialize>(std::make_tuple(RootState(), State()));
+
+	SDL_Event event {};
+	event.type = SDL_MOUSEMOTION;
+
+	std::cout << "controls: " << ROWS * COLUMNS << std::endl;
+
+	for (const std::size_t changed : { 0, 1, 10, 100, 500 })
+	{
+		auto state = repack(initial, std::get<State>(initial).with_changed(changed));
+
+		// Draw once, so that unchanged controls have draw commands to keep
+		state = application.layout<Operation::Draw>(state);
+
+		const auto &update = measure(frames, [&]
+		{
+			state = application.update(state, event);
+		});
+
+		const auto &draw = measure(frames, [&]
+		{
+			state = application.layout<Operation::Draw>(application.update(state, event));
+		});
+
+		std::cout << "changed: " << changed << std::endl;
+
+		print("update", update);
+		print("update + draw", draw);
+	}
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+#ifndef LEGACYGLYPHS_H
+#define LEGACYGLYPHS_H
+
+#include <freetype2/ft2build.h>
+
+#include FT_FREETYPE_H
+
+#include <array>
+#include <utility>
+
+#include <glm/vec4.hpp>
+
+// The glyph table builder that GlyphCache replaced, as it was, kept around to
+// compare startup and compile time against. Every level of the recursion
+// rasterizes one glyph and copies the whole table built so far.
+namespace legacy
+{
+	constexpr int TEXTURE_SIZE = 128;
+
+	struct Glyph
+	{
+		size_t index;
+
+		glm::vec4 bounds;
+
+		long ax; // advance.x
+		long ay; // advance.y
+
+		int offset;
+	};
+
+	inline glm::vec4 get_glyph_position(FT_Face face, uint x, uint y)
+	{
+		return (x + face->glyph->bitmap.width) > TEXTURE_SIZE
+			? glm::vec4(0, y + uint(face->height / 64), face->glyph->bitmap.width, face->glyph->bitmap.rows)
+			: glm::vec4(x, y, face->glyph->bitmap.width, face->glyph->bitmap.rows);
+	}
+
+	inline Glyph create_glyph(FT_Face face, size_t index, uint x, uint y)
+	{
+		FT_Load_Char(face, index, FT_LOAD_RENDER);
+
+		return
+		{
+			index,
+
+			get_glyph_position(face, x, y),
+
+			face->glyph->advance.x >> 6,
+			face->glyph->advance.y >> 6,
+			face->height / 64 - face->glyph->bitmap_top,
+		};
+	}
+
+	template<typename TElement, std::size_t TSize, std::size_t ...TIndex>
+	std::array<TElement, TSize + 1> array_append(const TElement &element, const std::array<TElement, TSize> &array, std::index_sequence<TIndex...>)
+	{
+		return { std::get<TIndex>(array)..., element };
+	}
+
+	template<typename TElement, std::size_t TSize>
+	std::array<TElement, TSize + 1> array_append(const TElement &element, const std::array<TElement, TSize> &array)
+	{
+		return array_append(element, array, std::make_index_sequence<TSize>());
+	}
+
+	template<std::size_t TStart, std::size_t TEnd>
+	struct create_glyphs
+	{
+		static auto value(FT_Face face, uint x, uint y)
+		{
+			const auto &glyph = create_glyph(face, TEnd - 1, x, y);
+			const auto &trailing = create_glyphs<TStart, TEnd - 1>::value(face, uint(glyph.bounds.x + glyph.bounds.z), uint(glyph.bounds.y));
+
+			return array_append(glyph, trailing);
+		}
+	};
+
+	template<std::size_t TStart>
+	struct create_glyphs<TStart, TStart>
+	{
+		static std::array<Glyph, 1> value(FT_Face face, uint x, uint y)
+		{
+			return { create_glyph(face, TStart - 1, x, y) };
+		}
+	};
+}
+
+#endif // LEGACYGLYPHS_H
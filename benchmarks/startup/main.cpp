@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+
+#include "Common.h"
+#include "LegacyGlyphs.h"
+
+// Compares the time it takes to get the glyphs of printable ASCII ready for
+// the first frame, from loading the font up to having the pixels to upload:
+//
+// * create_glyphs - the recursive table builder GlyphCache replaced, which
+//   rasterized every glyph a second time to upload it (see LegacyGlyphs.h)
+// * prewarm - GlyphCache rasterizing the glyphs into its atlas, as on the
+//   first start
+// * load - GlyphCache mapping the atlas saved by the first start
+//
+// Results are written to standard output as JSON, in milliseconds per start.
+// The time it takes to compile the builders is measured by
+// benchmarks/compile/glyphs.sh.
+//
+// Usage: startup [runs] [font]
+
+using Clock = std::chrono::steady_clock;
+
+static volatile uint64_t sink;
+
+template<typename TStart>
+double measure(int runs, const TStart &start)
+{
+	// Warm up, so that reading the font from disk is not part of the measurement
+	start();
+
+	const auto begin = Clock::now();
+
+	for (int i = 0; i < runs; i++)
+	{
+		start();
+	}
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - begin;
+
+	return elapsed.count() / runs;
+}
+
+// What the renderer is handed by GlyphCache::flush, added up so that the
+// work leading up to it is not optimized away
+uint64_t flush(GlyphCache &glyphs)
+{
+	uint64_t area = 0;
+
+	glyphs.flush([&](uint, const uint8_t *pixels, const Bounds &dirty)
+	{
+		area += uint64_t((dirty.max.x - dirty.min.x) * (dirty.max.y - dirty.min.y)) + pixels[0];
+	});
+
+	return area;
+}
+
+int main(int argc, char **argv)
+{
+	const int runs = argc > 1 ? std::atoi(argv[1]) : 20;
+	const std::string font = argc > 2 ? argv[2] : DEFAULT_FONT_PATH;
+	const std::string cache = std::string(P_tmpdir) + "/foam-startup.cache";
+
+	{
+		GlyphCache glyphs;
+
+		if (glyphs.add_font(font) == NO_FONT)
+		{
+			std::cerr << "Could not read " << font << std::endl;
+
+			return 1;
+		}
+
+		glyphs.prewarm(DEFAULT_FONT, DEFAULT_FONT_SIZE, 32, 127);
+		glyphs.save(cache, DEFAULT_FONT, DEFAULT_FONT_SIZE);
+	}
+
+	const auto create_glyphs = measure(runs, [&]
+	{
+		FT_Library library;
+		FT_Face face;
+
+		FT_Init_FreeType(&library);
+		FT_New_Face(library, font.c_str(), 0, &face);
+		FT_Set_Char_Size(face, 0, DEFAULT_FONT_SIZE * 64, GLYPH_DPI, GLYPH_DPI);
+
+		const auto &table = legacy::create_glyphs<33, 128>::value(face, 0, 0);
+
+		// What Application::run used to upload, glyph by glyph
+		for (const auto &glyph : table)
+		{
+			FT_Load_Char(face, glyph.index, FT_LOAD_RENDER);
+
+			sink = sink + face->glyph->bitmap.rows;
+		}
+
+		FT_Done_Face(face);
+		FT_Done_FreeType(library);
+	});
+
+	const auto prewarm = measure(runs, [&]
+	{
+		GlyphCache glyphs;
+		glyphs.add_font(font);
+		glyphs.prewarm(DEFAULT_FONT, DEFAULT_FONT_SIZE, 32, 127);
+
+		sink = glyphs.line_height(DEFAULT_FONT, DEFAULT_FONT_SIZE) + flush(glyphs);
+	});
+
+	const auto load = measure(runs, [&]
+	{
+		GlyphCache glyphs;
+		glyphs.add_font(font);
+
+		if (!glyphs.load(cache, DEFAULT_FONT, DEFAULT_FONT_SIZE))
+		{
+			glyphs.prewarm(DEFAULT_FONT, DEFAULT_FONT_SIZE, 32, 127);
+		}
+
+		sink = glyphs.line_height(DEFAULT_FONT, DEFAULT_FONT_SIZE) + flush(glyphs);
+	});
+
+	std::remove(cache.c_str());
+
+	std::cout << "{\"results\":["
+		<< "\n{\"path\":\"create_glyphs\",\"ms_per_start\":" << create_glyphs << "},"
+		<< "\n{\"path\":\"prewarm\",\"ms_per_start\":" << prewarm << "},"
+		<< "\n{\"path\":\"load\",\"ms_per_start\":" << load << "}"
+		<< "\n]}" << std::endl;
+
+	return 0;
+}
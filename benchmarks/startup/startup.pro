@@ -0,0 +1,13 @@
+TEMPLATE = app
+TARGET = startup
+INCLUDEPATH += ../.. /usr/include/SDL2
+CONFIG += c++17 link_pkgconfig
+CONFIG -= qt
+
+SOURCES += main.cpp
+
+HEADERS += LegacyGlyphs.h
+
+LIBS += -lSDL2 -lSDL2main -lGLEW -lGL
+
+PKGCONFIG += freetype2
@@ -0,0 +1,185 @@
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "Application.h"
+
+// Compares the frame time of the original upload path (glBufferData and
+// attribute setup every frame) with the StreamBuffer used by Application.
+//
+// Usage: upload [instances] [frames]
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<DrawCommand> create_scene(std::size_t instances)
+{
+	std::vector<DrawCommand> commands;
+
+	for (std::size_t i = 0; i < instances; i++)
+	{
+		const auto &position = glm::vec2((i * 8) % 800, ((i * 8) / 800) * 8 % 600);
+
+		commands.push_back(DrawCommand()
+			.with_position(position)
+			.with_size(glm::vec2(6, 6))
+			.with_color(0xff000000 | uint(i * 2654435761u))
+			);
+	}
+
+	return commands;
+}
+
+template<typename TFrame>
+double measure(SDL_Window *window, int frames, const TFrame &frame)
+{
+	// Warm up, so that buffer growth is not part of the measurement
+	for (int i = 0; i < 10; i++)
+	{
+		frame();
+
+		SDL_GL_SwapWindow(window);
+	}
+
+	glFinish();
+
+	const auto start = Clock::now();
+
+	for (int i = 0; i < frames; i++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		frame();
+
+		SDL_GL_SwapWindow(window);
+	}
+
+	glFinish();
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+	return elapsed.count() / frames;
+}
+
+int main(int argc, char **argv)
+{
+	const std::size_t instances = argc > 1 ? std::size_t(std::atoi(argv[1])) : 5000;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+	SDL_Init(SDL_INIT_VIDEO);
+
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+	SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+	auto window = SDL_CreateWindow("upload", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 800, 600, SDL_WINDOW_HIDDEN | SDL_WINDOW_OPENGL);
+	auto context = SDL_GL_CreateContext(window);
+
+	glewInit();
+
+	SDL_GL_SetSwapInterval(0);
+
+	const auto program = create_program();
+
+	glUseProgram(program);
+
+	static const GLfloat vertex_data[] =
+	{
+		0.f, 0.f,
+		1.f, 0.f,
+		1.f, 1.f,
+		0.f, 1.f
+	};
+
+	static const GLuint index_data[] =
+	{
+		0, 1, 2, 3
+	};
+
+	GLuint vbo;
+	GLuint ibo;
+	GLuint vao;
+	GLuint commands;
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vbo);
+	glGenBuffers(1, &ibo);
+	glGenBuffers(1, &commands);
+
+	glBindVertexArray(vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_data), vertex_data, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(index_data), index_data, GL_STATIC_DRAW);
+
+	const auto &scene = create_scene(instances);
+
+	const auto legacy = measure(window, frames, [&]
+	{
+		const immutable_vector<DrawCommand> frame(scene);
+
+		glBindVertexArray(vao);
+
+		for (GLuint attribute = 0; attribute <= 5; attribute++)
+		{
+			glEnableVertexAttribArray(attribute);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, commands);
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(frame.size() * sizeof(DrawCommand)), frame.data(), GL_STATIC_DRAW);
+
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(DrawCommand), offset(DrawCommand, color));
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(DrawCommand), offset(DrawCommand, uv));
+		glVertexAttribPointer(3, 2, GL_SHORT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, position));
+		glVertexAttribPointer(4, 2, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(DrawCommand), offset(DrawCommand, size));
+		glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(DrawCommand), offset(DrawCommand, page));
+
+		glVertexAttribDivisor(1, 1);
+		glVertexAttribDivisor(2, 1);
+		glVertexAttribDivisor(3, 1);
+		glVertexAttribDivisor(4, 1);
+		glVertexAttribDivisor(5, 1);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+
+		glDrawElementsInstanced(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, 0, GLsizei(frame.size()));
+	});
+
+	StreamBuffer stream;
+	stream.create(vbo, ibo);
+
+	const auto streaming = measure(window, frames, [&]
+	{
+		stream.upload(scene.size(), [&](DrawCommand *target)
+		{
+			return std::copy(std::begin(scene), std::end(scene), target);
+		});
+
+		glDrawElementsInstanced(GL_TRIANGLE_FAN, 4, GL_UNSIGNED_INT, 0, GLsizei(scene.size()));
+
+		stream.fence();
+	});
+
+	std::cout << "instances: " << instances << std::endl;
+	std::cout << "glBufferData: " << legacy << " ms/frame" << std::endl;
+	std::cout << "StreamBuffer: " << streaming << " ms/frame" << std::endl;
+
+	stream.destroy();
+
+	glDeleteBuffers(1, &commands);
+	glDeleteBuffers(1, &ibo);
+	glDeleteBuffers(1, &vbo);
+	glDeleteVertexArrays(1, &vao);
+
+	glUseProgram(0);
+	glDeleteProgram(program);
+
+	SDL_GL_DeleteContext(context);
+	SDL_DestroyWindow(window);
+
+	SDL_Quit();
+
+	return 0;
+}
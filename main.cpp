@@ -9,14 +9,15 @@
 #include "Component.h"
 #include "DefaultStyle.h"
 #include "TextBox.h"
+#include "ThreadedRenderer.h"
+#include "PerformanceOverlay.h"
+
+FOAM_COUNT_ALLOCATIONS
 
 struct State
 {
 	State()
 		: counter(0)
-		, frames(0)
-		, fps(0)
-		, time({0, 0})
 	{
 	}
 
@@ -28,28 +29,6 @@ struct State
 		return copy;
 	}
 
-	State increment_fps() const
-	{
-		State copy(*this);
-		copy.frames++;
-
-		return copy;
-	}
-
-	State swap_fps() const
-	{
-		State copy(*this);
-		copy.fps = frames;
-		copy.frames = 0;
-
-		return copy;
-	}
-
-	const std::string get_fps() const
-	{
-		return std::to_string(fps);
-	}
-
 	const std::string get_button_text() const
 	{
 		std::ostringstream stream;
@@ -59,10 +38,6 @@ struct State
 	}
 
 	int counter;
-	int frames;
-	int fps;
-
-	timespec time;
 };
 
 template<typename ...TParameters>
@@ -113,29 +88,11 @@ struct ButtonComposite : public Component<ButtonComposite<TParameters...>, TPara
 	}
 };
 
-struct MyApplication : public Application<MyApplication, State, DefaultStyle>
+struct MyApplication : public Application<MyApplication, State, DefaultStyle, ThreadedRenderer<GLRenderer>>
 {
 	State init_state() override
 	{
-		State state;
-
-		clock_gettime(CLOCK_MONOTONIC, &state.time);
-
-		return state;
-	}
-
-	State update_state(const State &state) override
-	{
-		State copy(state);
-
-		clock_gettime(CLOCK_MONOTONIC, &copy.time);
-
-		if ((copy.time.tv_sec - state.time.tv_sec) >= 1)
-		{
-			return copy.swap_fps();
-		}
-
-		return copy.increment_fps();
+		return State();
 	}
 
 	static State increment_counter(const State &state)
@@ -184,12 +141,10 @@ struct MyApplication : public Application<MyApplication, State, DefaultStyle>
 			size = glm::vec2(250, 150),
 			color = 0xfffcfcfc,
 
-			Text
+			PerformanceOverlay
 			{
 				position = glm::vec2(10, 170),
-				size = glm::vec2(250, 20),
-				color = 0xffffffff,
-				text = state.get_fps()
+				size = glm::vec2(250, 110)
 			}
 		};
 	}
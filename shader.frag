@@ -1,10 +1,11 @@
 #version 330 core
 
-uniform sampler2D texture;
+uniform sampler2DArray atlas;
 
 in vec4 v_color;
 in vec4 v_uv;
 in vec2 v_position;
+flat in uint v_page;
 
 void main(void)
 {
@@ -14,6 +15,6 @@ void main(void)
 	{
 		vec2 uv = vec2(v_uv.x + (v_uv.z * v_position.x), v_uv.y + (v_uv.w * v_position.y));
 
-		gl_FragColor = vec4(1, 1, 1, texture2D(texture, uv).r) * v_color;
+		gl_FragColor = vec4(1, 1, 1, texture(atlas, vec3(uv, v_page)).r) * v_color;
 	}
 }
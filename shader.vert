@@ -3,11 +3,14 @@
 layout(location = 0) in vec2 position;
 layout(location = 1) in vec4 color;
 layout(location = 2) in vec4 uv;
-layout(location = 3) in mat3 matrix;
+layout(location = 3) in vec2 origin;
+layout(location = 4) in vec2 size;
+layout(location = 5) in uint page;
 
 out vec4 v_color;
 out vec4 v_uv;
 out vec2 v_position;
+flat out uint v_page;
 
 void main(void)
 {
@@ -22,9 +25,10 @@ void main(void)
 		vec3(-(right + left) / (right - left), -(top + bottom) / (top - bottom), 1)
 	);
 
-	gl_Position = vec4(projection * matrix * vec3(position, 1), 1);
+	gl_Position = vec4(projection * vec3(origin + position * size, 1), 1);
 
 	v_color = color;
 	v_uv = uv;
 	v_position = position;
+	v_page = page;
 }